@@ -28,7 +28,7 @@ fi
 # others -> print error message
 
 # add -g flag if using gdb/lldb for debugging
-flags="-Wall -O2"
+flags="-Wall -O2 -pthread"
 
 case $1 in
     *.c) echo "C file"
@@ -36,9 +36,16 @@ case $1 in
         clang $flags -o ${1%.c} $1
         ;;
     *.cc|*.cpp) echo "C++ file"
-        flags="-std=c++11 $flags"
+        # enable the std_par reference when TBB is installed, it needs -ltbb
+        libs=""
+        if printf '#include <tbb/tbb.h>\nint main() { return 0; }\n' | clang++ -std=c++17 -x c++ - -ltbb -o /dev/null 2>/dev/null; then
+            flags="-std=c++17 -DHAVE_PARALLEL_STL $flags"
+            libs="-ltbb"
+        else
+            flags="-std=c++11 $flags"
+        fi
         ext=${1##*.}
-        clang++ $flags -o ${1%.$ext} $1
+        clang++ $flags -o ${1%.$ext} $1 $libs
         ;;
     *) echo "Unknown file type"
         ;;
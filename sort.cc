@@ -7,20 +7,230 @@
 #include <string>
 #include <cmath>
 #include <random>
+#include <climits>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <chrono>
+#include <sstream>
+// the std_par reference is opt in: build with -DHAVE_PARALLEL_STL and link -ltbb,
+// compiler.sh does both when TBB is installed
+#ifdef HAVE_PARALLEL_STL
+#if __cplusplus >= 201703L
+#include <execution>
+#endif
+#ifndef __cpp_lib_parallel_algorithm
+#undef HAVE_PARALLEL_STL
+#endif
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
+// test case generator
+// every value is a pure function of (seed, test case, index), so blocks generate on any thread
+// and the same seed always reproduces the same file
+enum Distribution
+{
+    UNIQUE,     // random permutation of 0 .. n - 1
+    SORTED,     // 0 .. n - 1
+    REVERSE,    // n - 1 .. 0
+    PARTIAL,    // sorted with 5% random outliers
+    FEW,        // 10 distinct values
+    RANDOM,     // uniform over the non-negative range of the element width
+    ZIPF,       // ranks 1 .. n with P(k) ~ 1 / k
+    GAUSSIAN,   // normal around 8n with standard deviation n
+    SAWTOOTH,   // 16 ascending runs
+    ORGANPIPE,  // ascending to the middle, then descending
+    KSORTED,    // every element at most sqrt(n) away from its sorted position
+    DUPLICATES, // sqrt(n) distinct values, each repeated about sqrt(n) times
+    DISTRIBUTION_COUNT
+};
+const char *DISTRIBUTION_NAMES[] = {
+    "unique", "sorted", "reverse", "partial", "few", "random",
+    "zipf", "gaussian", "sawtooth", "organpipe", "ksorted", "duplicates"};
+const int GENERATOR_BLOCK_SIZE = 1 << 16;
+const int MAX_CASE_SIZE = 1000000000;
+struct GeneratorOptions
+{
+    int total_cases;           // split evenly over the distributions
+    int case_size;             // elements per test case
+    int width;                 // element width in bits, 32 or 64
+    unsigned long long seed;   // same seed, same test cases
+    bool binary;               // write input.bin instead of input.txt
+    vector<int> distributions; // defaults to the first 6 distributions
+};
+// binary test case file: header, then per test case its size followed by the raw elements
+struct BinaryHeader
+{
+    char magic[8]; // "SORTBIN"
+    unsigned int width;
+    unsigned int reserved;
+    unsigned long long total_cases;
+};
+
+// size sweep
+// time algorithms over doubling sizes and fit the times to complexity models
+enum Complexity
+{
+    LINEAR,
+    LINEARITHMIC,
+    QUADRATIC,
+    COMPLEXITY_COUNT
+};
+const char *COMPLEXITY_NAMES[] = {"n", "n log n", "n^2"};
+const double SWEEP_MIN_MEASURE_MS = 2; // repeat small sorts until this much time is measured
+struct SweepOptions
+{
+    int min_size; // smallest size, doubled up to max_size
+    int max_size;
+    double budget; // ms per run, longer runs are skipped or aborted
+};
+
+// sort server
+// a resident process on a unix socket, each client shares its arrays through one memory segment
+// (a memfd passed over the socket) and the requests only carry offsets into it
+enum RequestType
+{
+    REQUEST_SEGMENT, // attach the segment passed with the request
+    REQUEST_SORT,    // sort count elements at offset in place
+    REQUEST_STATS
+};
+const int SERVER_BATCH_SIZE = 64;            // most jobs a worker takes from the queue at once
+const int SERVER_BATCH_ELEMENTS = 1 << 16;   // jobs are only batched while they add up to this many elements
+const int SERVER_COUNTING_RANGE = 1 << 24;   // largest value range counting sort may allocate counts for
+struct ServerRequest
+{
+    unsigned int type;
+    char algorithm[16];        // sort function name (SORT)
+    unsigned long long id;     // echoed in the response
+    unsigned long long offset; // first element in the segment (SORT), segment size in bytes (SEGMENT)
+    unsigned long long count;  // number of elements (SORT)
+};
+struct ServerResponse
+{
+    unsigned long long id;
+    int status; // 0 on success
+    // STATS only
+    unsigned long long requests, elements, batches;
+    double uptime_ms, mean_latency_us, max_latency_us;
+};
+struct ClientConnection
+{
+    int fd;
+    mutex write_lock;                // guards responses, pending and closed
+    condition_variable writable;     // wakes the writer thread
+    deque<ServerResponse> responses; // written in order by the connection's writer thread
+    int pending;                     // sort jobs queued but not answered yet
+    bool closed;                     // the reader saw the client disconnect
+    int *segment;
+    size_t segment_size;
+    ~ClientConnection()
+    {
+        if (segment)
+        {
+            munmap(segment, segment_size);
+        }
+        close(fd);
+    }
+};
+struct SortJob
+{
+    shared_ptr<ClientConnection> client;
+    ServerRequest request;
+    void (*sortFunction)(vector<int> &);
+    chrono::steady_clock::time_point received;
+};
+struct SortServer
+{
+    mutex lock;
+    condition_variable ready;
+    deque<SortJob> queue;
+    int workers;
+    chrono::steady_clock::time_point started;
+    unsigned long long requests, elements, batches;
+    double total_latency_us, max_latency_us;
+};
+
+// string sorting
+// strings live back to back in one arena (for files, the file buffer itself)
+// and the sorts only move (offset, length) handles
+struct StringHandle
+{
+    unsigned long long offset;
+    unsigned int length;
+};
+struct StringArena
+{
+    vector<char> chars;
+    vector<StringHandle> strings;
+};
+const int STRING_INSERTION_SIZE = 16; // smaller ranges are insertion sorted
+const int STRING_RADIX_SIZE = 64;     // smaller ranges fall back from radix sort to multikey quicksort
+const int STRING_CHUNK_SIZE = 7;      // characters per multikey quicksort key
+
+// benchmark
+// repeated runs per (distribution, algorithm), saved as a baseline and compared against later runs
+struct BenchOptions
+{
+    int runs;         // samples per distribution and algorithm
+    double threshold; // % slowdown that counts as a regression
+    string baseline;  // baseline file
+    bool save;        // write the results to the baseline file
+    bool compare;     // compare the results against the baseline file
+};
+struct BenchResult
+{
+    string host, compiler, date;
+    int size;
+    unsigned long long seed;
+    vector<string> distributions;
+    vector<string> algorithms;
+    map<pair<string, string>, vector<double>> samples; // (distribution, algorithm) -> ms per run
+};
+const double BENCH_SIGNIFICANCE = 0.05; // chance that a run without changes fails, split over the compared pairs
+
 // interface
-void generateTestCases(int = 60, int = 10000);
-void writeFile(vector<vector<int>> &);
+bool generateTestCases(const GeneratorOptions &);
 bool readFile(vector<vector<int>> &);
 void printArray(vector<int>);
 void printTestCaseSize(vector<vector<int>>);
-void test(vector<vector<int>>, string);
+vector<unsigned long long> checksum(const vector<vector<int>> &);
+void test(const vector<vector<int>> &, const vector<unsigned long long> &, string);
 // TODO: visualization_sorting
 
 // helper functions
-void random_shuffle(vector<int>::iterator, vector<int>::iterator);
+unsigned long long mix64(unsigned long long);
+unsigned long long counterRandom(unsigned long long, unsigned long long);
+long long permuteIndex(long long, long long, unsigned long long);
+long long generateValue(int, long long, long long, unsigned long long, int);
+void parallelFor(int, const function<void(int)> &);
+vector<string> splitList(const string &);
+vector<int> generateArray(int, int, unsigned long long);
+double timeSort(void (*)(vector<int> &), const vector<int> &, double);
+double complexityModel(int, double);
+double fitComplexity(int, const vector<double> &, const vector<double> &, double &);
+bool isSortedSpan(const int *, size_t);
+unsigned long long multisetHash(const int *, size_t);
 void swap(int &a, int &b)
 {
     // becareful when a and b are the same
@@ -72,19 +282,276 @@ void cocktailSort(vector<int> &);
 void combSort(vector<int> &);
 void gnomeSort(vector<int> &);
 
+// selection algorithms
+// place the k smallest elements at the front of the array (k is 1-based)
+void introSelect(vector<int> &, int);
+void floydRivestSelect(vector<int> &, int);
+void partialSort(vector<int> &, int);
+void topK(vector<int> &, int);
+
+// selection helpers
+int resolveK(int, int);
+void insertionSortRange(vector<int> &, int, int);
+void partition3(vector<int> &, int, int, int, int &, int &);
+int medianOfMedians(vector<int> &, int, int);
+void introSelectRange(vector<int> &, int, int, int, int);
+void floydRivestRange(vector<int> &, int, int, int);
+void testSelection(const vector<vector<int>> &, const vector<vector<int>> &, int, string, bool);
+
+// incremental sorting
+// a sorted base followed by a log of pending sorted runs, merged lazily
+const int GALLOP_BATCH_SIZE = 8; // batches this small are always merged by binary insertion
+const int MAX_PENDING_RUNS = 16; // compact once this many runs are pending
+const int COMPACT_RATIO = 32;    // compact once the pending runs exceed 1/32 of the base
+struct SortedRuns
+{
+    vector<int> data;       // sorted base followed by the pending sorted runs
+    vector<int> run_starts; // start index of each pending run, the base is [0, run_starts[0])
+    int scratch_limit;      // max elements a merge may buffer, larger merges are done in place
+};
+void appendBatch(SortedRuns &, const vector<int> &);
+void compactRuns(SortedRuns &);
+void incrementalBenchmark(vector<vector<int>> &);
+void sweep(const map<string, void (*)(vector<int> &)> &, const SweepOptions &, const GeneratorOptions &);
+int serve(const string &, const map<string, void (*)(vector<int> &)> &);
+int sortClient(const string &, const string &);
+int printServerStats(const string &);
+int bench(const map<string, void (*)(vector<int> &)> &, const BenchOptions &, const SweepOptions &, const GeneratorOptions &);
+void generateStrings(const string &, int, unsigned long long);
+bool readStringFile(const string &, StringArena &);
+void stringBenchmark(StringArena &);
+
+// benchmark helpers
+void stdSort(vector<int> &);
+void stdStableSort(vector<int> &);
+#ifdef HAVE_PARALLEL_STL
+void parallelStdSort(vector<int> &);
+#endif
+BenchResult runBenchmark(const map<string, void (*)(vector<int> &)> &, const vector<int> &, int, unsigned long long, int, double);
+bool saveBaseline(const string &, const BenchResult &);
+bool loadBaseline(const string &, BenchResult &);
+double median(vector<double>);
+vector<double> relativeSamples(const BenchResult &, const string &, const string &);
+double mannWhitneyP(const vector<double> &, const vector<double> &);
+
+// string sort algorithms
+void stdStringSort(StringArena &);
+void multikeyQuickSort(StringArena &);
+void msdRadixSort(StringArena &);
+void lcpMergeSort(StringArena &);
+
+// string sort helpers
+int charAt(const char *, const StringHandle &, size_t);
+unsigned long long chunkAt(const char *, const StringHandle &, size_t);
+size_t commonPrefix(const char *, const StringHandle &, const StringHandle &, size_t);
+bool lessFrom(const char *, const StringHandle &, const StringHandle &, size_t);
+void stringInsertionSort(const char *, StringHandle *, size_t, size_t);
+void multikeyQuickSortRange(const char *, StringHandle *, size_t, size_t);
+void msdRadixSortRange(const char *, StringHandle *, StringHandle *, int *, size_t, size_t);
+void lcpMergeSortRange(const char *, StringHandle *, size_t *, StringHandle *, size_t *, size_t);
+
+// server helpers
+bool readFull(int, void *, size_t, int * = NULL);
+bool writeFull(int, const void *, size_t, int = -1);
+int connectServer(const string &);
+void serverWorker(SortServer &);
+void connectionWriter(shared_ptr<ClientConnection>);
+bool serverCanSort(void (*)(vector<int> &), const vector<int> &);
+void queueResponse(ClientConnection &, const ServerResponse &, bool);
+void handleConnection(SortServer &, shared_ptr<ClientConnection>, const map<string, void (*)(vector<int> &)> &);
+
+// incremental helpers
+int gallopUpperBound(const vector<int> &, int, int, int);
+void gallopMerge(vector<int> &, int, int, int);
+void inPlaceMerge(vector<int> &, int, int, int);
+void mergeRuns(vector<int> &, int, int, int, int);
+
 int main(int argc, char *argv[])
 {
-    // seed the random number generator
-    srand(time(NULL));
+    // parse optional arguments, the rest are positional
+    // --k <k>: number of smallest elements to select (default: median)
+    // --size, --count, --width, --seed, --dist, --binary: test case generator options
+    // --min, --max, --budget: size sweep options (--seed and --dist apply as well)
+    // --socket <path>: unix socket of the sort server (default: sort.sock)
+    // --runs, --threshold, --baseline, --save, --compare: benchmark options
+    int k = 0;
+    string socket_path = "sort.sock";
+    BenchOptions bench_options = {10, 10, "baseline.txt", false, false};
+    SweepOptions sweep_options = {16, 1 << 20, 1000};
+    GeneratorOptions generator = {60, 10000, 32, (unsigned long long)time(NULL), false, {}};
+    bool size_given = false; // commands with a different default size need to know
+    vector<string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--binary" || arg == "--save" || arg == "--compare")
+        {
+            (arg == "--binary" ? generator.binary : arg == "--save" ? bench_options.save : bench_options.compare) = true;
+            continue;
+        }
+        if (arg.compare(0, 2, "--") != 0)
+        {
+            args.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            cerr << "Error: " << arg << " requires a value" << endl;
+            return 1;
+        }
+
+        string value = argv[++i];
+        if (arg == "--k")
+        {
+            k = atoi(value.c_str());
+            if (k <= 0)
+            {
+                cerr << "Error: --k requires a positive integer" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--size")
+        {
+            long long size = atoll(value.c_str());
+            if (size <= 0 || size > MAX_CASE_SIZE)
+            {
+                cerr << "Error: --size must be between 1 and " << MAX_CASE_SIZE << endl;
+                return 1;
+            }
+            generator.case_size = size;
+            size_given = true;
+        }
+        else if (arg == "--count")
+        {
+            generator.total_cases = atoi(value.c_str());
+            if (generator.total_cases <= 0)
+            {
+                cerr << "Error: --count requires a positive integer" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--width")
+        {
+            generator.width = atoi(value.c_str());
+            if (generator.width != 32 && generator.width != 64)
+            {
+                cerr << "Error: --width must be 32 or 64" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--min" || arg == "--max")
+        {
+            long long size = atoll(value.c_str());
+            if (size <= 0 || size > MAX_CASE_SIZE)
+            {
+                cerr << "Error: " << arg << " must be between 1 and " << MAX_CASE_SIZE << endl;
+                return 1;
+            }
+            (arg == "--min" ? sweep_options.min_size : sweep_options.max_size) = size;
+        }
+        else if (arg == "--budget")
+        {
+            sweep_options.budget = atof(value.c_str());
+            if (sweep_options.budget <= 0)
+            {
+                cerr << "Error: --budget requires a positive number of ms" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--runs")
+        {
+            bench_options.runs = atoi(value.c_str());
+            // with 2 runs on each side the one-sided Mann-Whitney p never drops below 0.12
+            if (bench_options.runs < 3)
+            {
+                cerr << "Error: --runs must be at least 3" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--threshold")
+        {
+            bench_options.threshold = atof(value.c_str());
+            if (bench_options.threshold <= 0)
+            {
+                cerr << "Error: --threshold requires a positive percentage" << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--baseline")
+        {
+            bench_options.baseline = value;
+        }
+        else if (arg == "--socket")
+        {
+            socket_path = value;
+        }
+        else if (arg == "--seed")
+        {
+            generator.seed = strtoull(value.c_str(), NULL, 10);
+        }
+        else if (arg == "--dist")
+        {
+            // comma separated distribution names
+            for (auto &name : splitList(value))
+            {
+                int d = 0;
+                while (d < DISTRIBUTION_COUNT && name != DISTRIBUTION_NAMES[d])
+                {
+                    d++;
+                }
+                if (d == DISTRIBUTION_COUNT)
+                {
+                    cerr << "Error: Unknown distribution " << name << endl;
+                    return 1;
+                }
+                generator.distributions.push_back(d);
+            }
+        }
+        else
+        {
+            cerr << "Error: Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+    argc = args.size() + 1;
+
+    // available commands map to sort functions
+    map<string, void (*)(vector<int> &)> sortFunctions = {
+        {"bubble", bubbleSort},
+        {"selection", selectionSort},
+        {"insertion", insertionSort},
+        {"merge", mergeSort},
+        {"quick", quickSort},
+        {"heap", heapSort},
+        {"counting", countingSort},
+        {"radix", radixSort},
+        {"bucket", bucketSort},
+        {"shell", shellSort},
+        {"cocktail", cocktailSort},
+        {"comb", combSort},
+        {"gnome", gnomeSort}};
+
+    if (generator.distributions.empty())
+    {
+        generator.distributions = {UNIQUE, SORTED, REVERSE, PARTIAL, FEW, RANDOM};
+    }
 
     // generate test cases and write to file if argument is provided
-    if (argc == 2 && string(argv[1]) == "gen")
+    if (argc == 2 && args[0] == "gen")
     {
-        generateTestCases();
-        cout << "Test cases generated: input.txt" << endl;
+        if (!generateTestCases(generator))
+        {
+            return 1;
+        }
+        cout << "Test cases generated: " << (generator.binary ? "input.bin" : "input.txt");
+        cout << " (seed " << generator.seed << ")" << endl;
+        if (generator.width == 64)
+        {
+            cout << "Note: 64-bit test cases are for external tools, the sorts read 32-bit elements" << endl;
+        }
         return 0;
     } // show test cases if argument is provided
-    else if (argc == 2 && string(argv[1]) == "show")
+    else if (argc == 2 && args[0] == "show")
     {
         vector<vector<int>> arraylist;
         if (!readFile(arraylist))
@@ -93,16 +560,109 @@ int main(int argc, char *argv[])
         }
         printTestCaseSize(arraylist);
         return 0;
+    } // benchmark appending batches to sorted data if argument is provided
+    else if (argc == 2 && args[0] == "incremental")
+    {
+        vector<vector<int>> arraylist;
+        if (!readFile(arraylist))
+        {
+            return 1;
+        }
+        incrementalBenchmark(arraylist);
+        return 0;
+    } // sweep sizes or benchmark with the given algorithms (default: all) if argument is provided
+    else if ((argc == 2 || argc == 3) && (args[0] == "sweep" || args[0] == "bench"))
+    {
+        map<string, void (*)(vector<int> &)> algorithms;
+        for (auto &name : splitList(argc == 3 ? args[1] : ""))
+        {
+            if (sortFunctions.find(name) == sortFunctions.end())
+            {
+                cerr << "Error: Invalid algorithm " << name << endl;
+                return 1;
+            }
+            algorithms[name] = sortFunctions[name];
+        }
+        if (args[0] == "bench")
+        {
+            return bench(argc == 3 ? algorithms : sortFunctions, bench_options, sweep_options, generator);
+        }
+        if (sweep_options.min_size > sweep_options.max_size)
+        {
+            cerr << "Error: --min must not be larger than --max" << endl;
+            return 1;
+        }
+        sweep(argc == 3 ? algorithms : sortFunctions, sweep_options, generator);
+        return 0;
+    } // run the sort server if argument is provided
+    else if (argc == 2 && args[0] == "serve")
+    {
+        return serve(socket_path, sortFunctions);
+    } // sort the test cases on the sort server if argument is provided
+    else if (argc == 3 && args[0] == "client")
+    {
+        return sortClient(socket_path, args[1]);
+    } // generate a string dataset with long shared prefixes if argument is provided
+    else if (argc == 2 && args[0] == "genstrings")
+    {
+        int count = size_given ? generator.case_size : 1000000;
+        generateStrings("strings.txt", count, generator.seed);
+        cout << "Strings generated: strings.txt (" << count << " lines, seed " << generator.seed << ")" << endl;
+        return 0;
+    } // sort the lines of a file with all string algorithms if argument is provided
+    else if ((argc == 2 || argc == 3) && args[0] == "strings")
+    {
+        StringArena arena;
+        if (!readStringFile(argc == 3 ? args[1] : "strings.txt", arena))
+        {
+            return 1;
+        }
+        stringBenchmark(arena);
+        return 0;
+    } // show the sort server counters if argument is provided
+    else if (argc == 2 && args[0] == "stats")
+    {
+        return printServerStats(socket_path);
     } // show help message if argument is provided
-    else if (argc == 2 && string(argv[1]) == "help")
+    else if (argc == 2 && args[0] == "help")
     {
-        cout << "Usage: ./sort [gen|help|<algo_name>]" << endl;
+        cout << "Usage: ./sort [gen|show|incremental|sweep|bench|serve|client|stats|genstrings|strings|help|all|<algo_name>|<select_name>] [--k <k>]" << endl;
         cout << "\nOptions:" << endl;
         cout << "gen: generate test cases and write to file" << endl;
+        cout << "  --size <n>: elements per test case (default: 10000, max: 1000000000)" << endl;
+        cout << "  --count <c>: number of test cases, split evenly over the distributions (default: 60)" << endl;
+        cout << "  --dist <d1,d2,...>: distributions (default: unique,sorted,reverse,partial,few,random)" << endl;
+        cout << "     available: unique, sorted, reverse, partial, few, random, zipf, gaussian," << endl;
+        cout << "                sawtooth, organpipe, ksorted, duplicates" << endl;
+        cout << "  --width <32|64>: element width in bits (default: 32)" << endl;
+        cout << "  --seed <s>: seed, the same seed reproduces the same test cases (default: time)" << endl;
+        cout << "  --binary: write input.bin instead of input.txt" << endl;
         cout << "show: show test cases" << endl;
+        cout << "incremental: compare merging appended batches against full re-sorts" << endl;
+        cout << "sweep [algo1,algo2,...]: time algorithms over doubling sizes, fit complexities and report crossovers" << endl;
+        cout << "  --min <n>, --max <n>: size range (default: 16 .. 1048576)" << endl;
+        cout << "  --budget <ms>: time budget per run, projected or actual overruns are skipped (default: 1000)" << endl;
+        cout << "  --dist and --seed as for gen" << endl;
+        cout << "bench [algo1,algo2,...]: benchmark against std::sort, std::stable_sort (and the parallel STL)" << endl;
+        cout << "  --runs <r>: runs per distribution and algorithm (default: 10, min: 3)" << endl;
+        cout << "  --save: save the results with host and compiler to the baseline file" << endl;
+        cout << "  --compare: compare against the baseline file, exit 1 when an algorithm got significantly slower relative to std::sort" << endl;
+        cout << "  --threshold <pct>: slowdown that counts as a regression (default: 10)" << endl;
+        cout << "  --baseline <file>: baseline file (default: baseline.txt)" << endl;
+        cout << "  --size, --dist, --seed as for gen, --budget as for sweep" << endl;
+        cout << "serve: run a resident sort server on a unix socket" << endl;
+        cout << "client <algo_name>: sort the test cases on the sort server" << endl;
+        cout << "stats: show the sort server latency and throughput counters" << endl;
+        cout << "  --socket <path>: unix socket of the sort server (default: sort.sock)" << endl;
+        cout << "genstrings: generate strings.txt, lines with long shared prefixes (--size lines, default: 1000000)" << endl;
+        cout << "strings [file]: sort the lines of file (default: strings.txt) with all string algorithms" << endl;
         cout << "help: show help message" << endl;
+        cout << "all: run every sort and selection algorithm and report performance" << endl;
         cout << "<algo_name>: sort the test cases with the specified algorithm" << endl;
+        cout << "<select_name>: select the k smallest elements of each test case" << endl;
+        cout << "--k <k>: number of smallest elements to select (default: median)" << endl;
         cout << "Available algorithms: bubble, selection, insertion, merge, quick, heap, counting, radix, bucket, shell, cocktail, comb, gnome" << endl;
+        cout << "Available selections: nth, floyd, partial, topk" << endl;
         return 0;
     } // no argument provided is not allowed
     else if (argc == 1)
@@ -122,27 +682,21 @@ int main(int argc, char *argv[])
     } // sort the array if two arguments are provided
     else
     {
-        // available commands map to sort functions
-        map<string, void (*)(vector<int> &)> sortFunctions = {
-            {"bubble", bubbleSort},
-            {"selection", selectionSort},
-            {"insertion", insertionSort},
-            {"merge", mergeSort},
-            {"quick", quickSort},
-            {"heap", heapSort},
-            {"counting", countingSort},
-            {"radix", radixSort},
-            {"bucket", bucketSort},
-            {"shell", shellSort},
-            {"cocktail", cocktailSort},
-            {"comb", combSort},
-            {"gnome", gnomeSort}};
+        // available commands map to selection functions
+        // the bool marks whether the selected prefix is also sorted
+        map<string, pair<void (*)(vector<int> &, int), bool>> selectFunctions = {
+            {"nth", {introSelect, false}},
+            {"floyd", {floydRivestSelect, false}},
+            {"partial", {partialSort, true}},
+            {"topk", {topK, true}}};
 
         // user input
-        string command = argv[1];
+        string command = args[0];
 
         // check if the command is valid
-        if (sortFunctions.find(command) == sortFunctions.end() && command != "all")
+        if (sortFunctions.find(command) == sortFunctions.end() &&
+            selectFunctions.find(command) == selectFunctions.end() &&
+            command != "all")
         {
             cerr << "Error: Invalid command" << endl;
             return 1;
@@ -155,6 +709,9 @@ int main(int argc, char *argv[])
             return 1;
         }
 
+        // fingerprint the test cases before sorting to verify the output is a permutation
+        vector<unsigned long long> hashes = checksum(arraylist);
+
         // time the sorting process
         clock_t start, end;
         double duration = 0;
@@ -185,7 +742,29 @@ int main(int argc, char *argv[])
                 durations[sortFunction.first] = duration;
 
                 // test the sorted array
-                test(arraylist_copy, sortFunction.first);
+                test(arraylist_copy, hashes, sortFunction.first);
+            }
+
+            // select the k smallest elements with all selection algorithms
+            for (auto &selectFunction : selectFunctions)
+            {
+                duration = 0;
+
+                vector<vector<int>> arraylist_copy(arraylist);
+
+                start = clock();
+
+                for (auto &array : arraylist_copy)
+                {
+                    selectFunction.second.first(array, k);
+                }
+
+                end = clock();
+                duration = (double)(end - start) / CLOCKS_PER_SEC * 1000 / arraylist.size();
+
+                durations[selectFunction.first] = duration;
+
+                testSelection(arraylist, arraylist_copy, k, selectFunction.first, selectFunction.second.second);
             }
 
             // sort the durations
@@ -194,11 +773,33 @@ int main(int argc, char *argv[])
                  { return a.second < b.second; });
 
             cout << "Performance:" << endl;
+            cout << "(selection k = " << (k ? to_string(k) : "median") << ")" << endl;
             for (auto &duration : sortedDurations)
             {
                 cout << duration.first << ": " << duration.second << " ms per test case" << endl;
             }
         }
+        else if (selectFunctions.find(command) != selectFunctions.end())
+        {
+            duration = 0;
+            cout << "Selecting with " << command << " (k = " << (k ? to_string(k) : "median") << ")..." << endl;
+
+            // keep the original test cases to verify the selection
+            vector<vector<int>> arraylist_copy(arraylist);
+
+            start = clock();
+
+            for (auto &array : arraylist_copy)
+            {
+                selectFunctions[command].first(array, k);
+            }
+
+            end = clock();
+            duration = (double)(end - start) / CLOCKS_PER_SEC * 1000 / arraylist.size();
+            cout << "Time: " << duration << " ms per test case" << endl;
+
+            testSelection(arraylist, arraylist_copy, k, command, selectFunctions[command].second);
+        }
         else
         {
             duration = 0;
@@ -215,144 +816,239 @@ int main(int argc, char *argv[])
             cout << "Time: " << duration << " ms per test case" << endl;
 
             // test the sorted array
-            test(arraylist, command);
+            test(arraylist, hashes, command);
         }
         return 0;
     }
     return 0;
 }
 
-void random_shuffle(vector<int>::iterator first, vector<int>::iterator last)
+unsigned long long mix64(unsigned long long x)
 {
-    // Fisher-Yates shuffle algorithm
-    // shuffle the elements in the range [first, last)
-    for (auto i = last - first - 1; i > 0; i--)
-    {
-        auto j = rand() % (i + 1);
-        swap(first[i], first[j]);
-    }
+    // splitmix64 finalizer, every input bit affects every output bit
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
 }
 
-void generateTestCases(int total_cases, int case_size)
+unsigned long long counterRandom(unsigned long long key, unsigned long long counter)
 {
-    // TODO: More variety of test cases
+    // counter-based generator: the counter-th output of the stream selected by key
+    // no state is carried between calls, so any part of a stream can be generated on any thread
+    return mix64(key + (counter + 1) * 0x9e3779b97f4a7c15ULL);
+}
 
-    vector<vector<int>> arraylist;
+long long permuteIndex(long long i, long long m, unsigned long long key)
+{
+    // keyed bijection on [0, m): a 4 round Feistel network over the smallest even bit width covering m
+    // results outside [0, m) are encrypted again (cycle walking) until they fall inside
 
-    // divide the test cases into 6 categories
-    // 1. unique random
-    // 2. sorted
-    // 3. reverse sorted
-    // 4. partially sorted
-    // 5. few unique
-    // 6. random
+    int half = 1;
+    while ((1LL << (2 * half)) < m)
+    {
+        half++;
+    }
+    unsigned long long mask = (1ULL << half) - 1;
 
-    // generate unique random test cases
-    for (int i = 0; i < total_cases / 6; i++)
+    unsigned long long x = i;
+    do
     {
-        vector<int> array;
-        for (int j = 0; j < case_size; j++)
+        unsigned long long left = x >> half;
+        unsigned long long right = x & mask;
+        for (int round = 0; round < 4; round++)
         {
-            array.push_back(j);
+            unsigned long long next = left ^ (mix64(right ^ (key + round * 0x9e3779b97f4a7c15ULL)) & mask);
+            left = right;
+            right = next;
         }
-        random_shuffle(array.begin(), array.end());
-        arraylist.push_back(array);
+        x = (left << half) | right;
+    } while (x >= (unsigned long long)m);
+    return x;
+}
+
+long long generateValue(int distribution, long long i, long long n, unsigned long long key, int width)
+{
+    // value at index i of a test case of size n
+
+    const double TWO_POW_MINUS_53 = 1.0 / 9007199254740992.0;
+    unsigned long long r = counterRandom(key, i);
+    long long root = max(2LL, (long long)sqrt((double)n));
+
+    switch (distribution)
+    {
+    case UNIQUE:
+        return permuteIndex(i, n, key);
+    case SORTED:
+        return i;
+    case REVERSE:
+        return n - 1 - i;
+    case PARTIAL:
+        return r % 100 < 5 ? (long long)((r >> 8) % n) : i;
+    case FEW:
+        return r % 10;
+    case RANDOM:
+        return r >> (width == 32 ? 33 : 1);
+    case ZIPF:
+    {
+        // inverse of the continuous approximation of the harmonic CDF
+        double u = (r >> 11) * TWO_POW_MINUS_53;
+        return min(n, max(1LL, (long long)exp(u * log((double)n + 1))));
+    }
+    case GAUSSIAN:
+    {
+        // Box-Muller with two uniforms from the counters 2i and 2i + 1
+        double u1 = ((counterRandom(key, 2 * i) >> 11) + 1) * TWO_POW_MINUS_53;
+        double u2 = (counterRandom(key, 2 * i + 1) >> 11) * TWO_POW_MINUS_53;
+        double z = sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+        double mean = width == 32 ? min(8.0 * n, 1073741824.0) : 8.0 * n;
+        return max(0LL, (long long)llround(mean + z * mean / 8));
+    }
+    case SAWTOOTH:
+        return i % max(1LL, n / 16);
+    case ORGANPIPE:
+        return i < n / 2 ? i : n - 1 - i;
+    case KSORTED:
+    {
+        // shuffle within blocks of sqrt(n) elements
+        long long block = i / root * root;
+        return block + permuteIndex(i - block, min(root, n - block), mix64(key ^ block));
     }
+    case DUPLICATES:
+        return r % root;
+    }
+    return 0;
+}
+
+bool generateTestCases(const GeneratorOptions &options)
+{
+    // test case c uses distribution c * D / total_cases, so the distributions get equal shares
+    // each test case is generated in blocks across all threads and streamed to the file in order,
+    // only one round of blocks is kept in memory
 
-    // generate sorted test cases
-    for (int i = 0; i < total_cases / 6; i++)
+    const char *filename = options.binary ? "input.bin" : "input.txt";
+    FILE *file = fopen(filename, "wb");
+    if (!file)
     {
-        vector<int> array;
-        for (int j = 0; j < case_size; j++)
-        {
-            array.push_back(j);
-        }
-        arraylist.push_back(array);
+        cerr << "Error opening file" << endl;
+        return false;
     }
+    // readFile prefers input.bin, remove it so a stale file is never read instead
+    remove(options.binary ? "input.txt" : "input.bin");
 
-    // generate reverse sorted test cases
-    for (int i = 0; i < total_cases / 6; i++)
+    if (options.binary)
     {
-        vector<int> array;
-        for (int j = case_size - 1; j >= 0; j--)
-        {
-            array.push_back(j);
-        }
-        arraylist.push_back(array);
+        BinaryHeader header = {"SORTBIN", (unsigned int)options.width, 0, (unsigned long long)options.total_cases};
+        fwrite(&header, sizeof(header), 1, file);
     }
 
-    // generate partially sorted test cases
-    for (int i = 0; i < total_cases / 6; i++)
+    long long n = options.case_size;
+    int element_bytes = options.width / 8;
+    int threads = max(1, (int)thread::hardware_concurrency());
+    long long blocks_per_case = (n + GENERATOR_BLOCK_SIZE - 1) / GENERATOR_BLOCK_SIZE;
+    vector<string> buffers(4 * threads);
+
+    for (int c = 0; c < options.total_cases; c++)
     {
-        vector<int> array;
-        for (int j = 0; j < case_size; j++)
+        int distribution = options.distributions[(long long)c * options.distributions.size() / options.total_cases];
+        unsigned long long key = mix64(options.seed ^ mix64(c + 1));
+
+        if (options.binary)
         {
-            array.push_back(j);
+            unsigned long long size = n;
+            fwrite(&size, sizeof(size), 1, file);
         }
-        random_shuffle(array.begin(), array.end());
-        for (int j = 0; j < case_size / 2; j++)
+
+        for (long long first_block = 0; first_block < blocks_per_case; first_block += buffers.size())
         {
-            swap(array[j], array[j + 1]);
+            int blocks = min((long long)buffers.size(), blocks_per_case - first_block);
+
+            parallelFor(blocks, [&](int b)
+                        {
+                string &buffer = buffers[b];
+                long long begin = (first_block + b) * GENERATOR_BLOCK_SIZE;
+                long long end = min(n, begin + GENERATOR_BLOCK_SIZE);
+                if (options.binary)
+                {
+                    buffer.resize((end - begin) * element_bytes);
+                    for (long long i = begin; i < end; i++)
+                    {
+                        long long value = generateValue(distribution, i, n, key, options.width);
+                        int value32 = value;
+                        memcpy(&buffer[(i - begin) * element_bytes], element_bytes == 4 ? (const void *)&value32 : (const void *)&value, element_bytes);
+                    }
+                    return;
+                }
+                buffer.clear();
+                char digits[24];
+                for (long long i = begin; i < end; i++)
+                {
+                    long long value = generateValue(distribution, i, n, key, options.width);
+                    // format the non-negative value backwards followed by a space
+                    int pos = sizeof(digits);
+                    digits[--pos] = ' ';
+                    do
+                    {
+                        digits[--pos] = '0' + value % 10;
+                        value /= 10;
+                    } while (value);
+                    buffer.append(digits + pos, sizeof(digits) - pos);
+                } });
+
+            for (int b = 0; b < blocks; b++)
+            {
+                fwrite(buffers[b].data(), 1, buffers[b].size(), file);
+            }
         }
-        arraylist.push_back(array);
-    }
 
-    // generate few unique test cases
-    for (int i = 0; i < total_cases / 6; i++)
-    {
-        vector<int> array;
-        for (int j = 0; j < case_size; j++)
+        if (!options.binary)
         {
-            array.push_back(j % 10);
+            fputc('\n', file);
         }
-        random_shuffle(array.begin(), array.end());
-        arraylist.push_back(array);
     }
 
-    // generate random test cases
-    for (int i = 0; i < total_cases / 6; i++)
+    bool ok = !ferror(file);
+    fclose(file);
+    if (!ok)
     {
-        vector<int> array;
-        for (int j = 0; j < case_size; j++)
-        {
-            array.push_back(rand());
-        }
-        arraylist.push_back(array);
+        cerr << "Error writing file" << endl;
     }
-
-    // write the test cases to file
-    writeFile(arraylist);
+    return ok;
 }
 
-void writeFile(vector<vector<int>> &arraylist)
+bool readFile(vector<vector<int>> &arraylist)
 {
-    // TODO: Optimize the file writing process
+    // read input.bin if it exists, otherwise parse input.txt (one test case per line)
 
-    ofstream file(
-        "input.txt",
-        ios::out | ios::app);
-    if (file.is_open())
+    FILE *file = fopen("input.bin", "rb");
+    if (file)
     {
-        for (int i = 0; i < arraylist.size(); i++)
+        BinaryHeader header;
+        bool ok = fread(&header, sizeof(header), 1, file) == 1 && strcmp(header.magic, "SORTBIN") == 0;
+        if (ok && header.width != 32)
+        {
+            cerr << "Error: input.bin has " << header.width << "-bit elements, the sorts take 32-bit elements" << endl;
+            fclose(file);
+            return false;
+        }
+        for (unsigned long long c = 0; ok && c < header.total_cases; c++)
         {
-            for (int j = 0; j < arraylist[i].size(); j++)
+            unsigned long long size;
+            ok = fread(&size, sizeof(size), 1, file) == 1;
+            if (ok)
             {
-                file << arraylist[i][j] << " ";
+                arraylist.push_back(vector<int>(size));
+                ok = fread(arraylist.back().data(), sizeof(int), size, file) == size;
             }
-            file << endl;
         }
-        file.close();
+        fclose(file);
+        if (!ok)
+        {
+            cerr << "Error reading input.bin" << endl;
+        }
+        return ok;
     }
-}
-
-bool readFile(vector<vector<int>> &arraylist)
-{
-    // TODO: Optimize the file reading process
-
-    ifstream file(
-        "input.txt",
-        ios::in);
 
+    file = fopen("input.txt", "rb");
     if (!file)
     {
         cerr << "Error opening file" << endl;
@@ -360,32 +1056,43 @@ bool readFile(vector<vector<int>> &arraylist)
         return false;
     }
 
-    file.seekg(0, ios::end);
-    int length = file.tellg();
-    file.seekg(0, ios::beg);
-
-    char *buffer = new char[length];
-    file.read(buffer, length);
-    file.close();
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
 
-    string str(buffer);
-    delete[] buffer;
+    vector<char> buffer(length + 1);
+    length = fread(buffer.data(), 1, length, file);
+    fclose(file);
+    buffer[length] = '\0';
 
-    size_t pos = 0;
-    string token;
-    while ((pos = str.find("\n")) != string::npos)
+    // walk the buffer once, a line that is not terminated by a newline is ignored
+    const char *p = buffer.data();
+    const char *end = p + length;
+    vector<int> array;
+    while (p < end)
     {
-        token = str.substr(0, pos);
-        vector<int> array;
-        size_t pos2 = 0;
-        while ((pos2 = token.find(" ")) != string::npos)
+        if (*p == '\n')
+        {
+            arraylist.push_back(move(array));
+            array.clear();
+            p++;
+        }
+        else if (*p == ' ' || *p == '\r' || *p == '\t')
+        {
+            p++;
+        }
+        else
         {
-            array.push_back(stoi(token.substr(0, pos2)));
-            token.erase(0, pos2 + 1);
+            char *next;
+            long long value = strtoll(p, &next, 10);
+            if (next == p || value < INT_MIN || value > INT_MAX)
+            {
+                cerr << "Error: input.txt contains a value that is not a 32-bit integer" << endl;
+                return false;
+            }
+            array.push_back(value);
+            p = next;
         }
-        // array.push_back(stoi(token));
-        arraylist.push_back(array);
-        str.erase(0, pos + 1);
     }
 
     return true;
@@ -411,76 +1118,208 @@ void printTestCaseSize(vector<vector<int>> arraylist)
     }
 }
 
-void test(vector<vector<int>> arraylist, string sort_name)
+void parallelFor(int count, const function<void(int)> &body)
 {
-    int incorrect_cases = 0;
-    int total_cases = arraylist.size();
-    // int first_incorrect_case = -1;
+    // run body(0) ... body(count - 1) on all hardware threads
+    // workers claim the next index from a shared counter so uneven items balance out
 
-    // ensure each test case is increasing
-    for (int i = 0; i < arraylist.size(); i++)
+    int threads = min((int)thread::hardware_concurrency(), count);
+    atomic<int> next(0);
+    auto worker = [&]()
     {
-        for (int j = 0; j < arraylist[i].size() - 1; j++)
+        for (int i = next++; i < count; i = next++)
         {
-            if (arraylist[i][j] > arraylist[i][j + 1])
-            {
-                incorrect_cases++;
-                // first_incorrect_case = i;
-                break;
-            }
+            body(i);
         }
-    }
+    };
 
-    if (incorrect_cases)
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++)
     {
-        cout << sort_name << " Test Failed: ";
-        cout << (total_cases - incorrect_cases) << "/" << total_cases << endl;
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto &t : pool)
+    {
+        t.join();
     }
 }
 
-void bubbleSort(vector<int> &array)
+vector<string> splitList(const string &list)
 {
-    // repeatedly swap adjacent elements if they are in the wrong order
-
-    for (int i = 0; i < array.size(); i++)
+    // split a comma separated list, an empty string gives an empty list
+    vector<string> items;
+    stringstream stream(list);
+    string item;
+    while (getline(stream, item, ','))
     {
-        for (int j = 0; j < array.size() - i - 1; j++)
-        {
-            if (array[j] > array[j + 1])
-            {
-                swap(array[j], array[j + 1]);
-            }
-        }
+        items.push_back(item);
     }
+    return items;
 }
 
-void selectionSort(vector<int> &array)
+bool isSortedSpan(const int *data, size_t n)
 {
-    // select the minimum element from the unsorted part and place it at the beginning of the sorted part
+    // compare every element with its right neighbour without branching
+    // SSE2 compares 4 adjacent pairs at once, the tail is compared one pair at a time
 
-    for (int i = 0; i < array.size(); i++)
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128i unsorted = _mm_setzero_si128();
+    for (; i + 4 < n; i += 4)
     {
-        int min_index = i;
-        for (int j = i + 1; j < array.size(); j++)
-        {
-            if (array[j] < array[min_index])
-            {
-                min_index = j;
-            }
-        }
-        if (min_index != i)
-            swap(array[i], array[min_index]);
+        __m128i a = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(data + i + 1));
+        unsorted = _mm_or_si128(unsorted, _mm_cmpgt_epi32(a, b));
+    }
+    if (_mm_movemask_epi8(unsorted))
+    {
+        return false;
+    }
+#endif
+    int unsorted_pairs = 0;
+    for (; i + 1 < n; i++)
+    {
+        unsorted_pairs |= data[i] > data[i + 1];
     }
+    return !unsorted_pairs;
 }
 
-void insertionSort(vector<int> &array)
+unsigned long long multisetHash(const int *data, size_t n)
 {
-    // insert an element from the unsorted part into its correct position in the sorted part
+    // sum of a strong 64-bit mix of every element
+    // addition is order independent, so the hash of a permutation is unchanged
+    // while a dropped or duplicated element changes it with high probability
 
-    for (int i = 1; i < array.size(); i++)
+    unsigned long long hash = 0;
+    for (size_t i = 0; i < n; i++)
     {
-        int key = array[i];
-        int j = i - 1;
+        hash += mix64((unsigned int)data[i] + 0x9e3779b97f4a7c15ULL);
+    }
+    return hash;
+}
+
+// verification works on chunks so a single large test case is still split across threads
+const size_t VERIFY_CHUNK_SIZE = 1 << 18;
+
+vector<pair<int, size_t>> verifyChunks(const vector<vector<int>> &arraylist)
+{
+    // (test case, offset) of every chunk
+    vector<pair<int, size_t>> chunks;
+    for (int i = 0; i < (int)arraylist.size(); i++)
+    {
+        for (size_t offset = 0; offset < arraylist[i].size(); offset += VERIFY_CHUNK_SIZE)
+        {
+            chunks.push_back(make_pair(i, offset));
+        }
+    }
+    return chunks;
+}
+
+vector<unsigned long long> checksum(const vector<vector<int>> &arraylist)
+{
+    vector<pair<int, size_t>> chunks = verifyChunks(arraylist);
+    vector<unsigned long long> partial(chunks.size());
+
+    parallelFor(chunks.size(), [&](int c)
+                {
+        const vector<int> &array = arraylist[chunks[c].first];
+        size_t offset = chunks[c].second;
+        partial[c] = multisetHash(array.data() + offset, min(VERIFY_CHUNK_SIZE, array.size() - offset)); });
+
+    vector<unsigned long long> hashes(arraylist.size(), 0);
+    for (size_t c = 0; c < chunks.size(); c++)
+    {
+        hashes[chunks[c].first] += partial[c];
+    }
+    return hashes;
+}
+
+void test(const vector<vector<int>> &arraylist, const vector<unsigned long long> &hashes, string sort_name)
+{
+    int incorrect_cases = 0;
+    int total_cases = arraylist.size();
+
+    // ensure each test case is increasing, a chunk also checks the first element of the next chunk
+    // and each test case is a permutation of the unsorted input
+    vector<pair<int, size_t>> chunks = verifyChunks(arraylist);
+    vector<char> chunk_sorted(chunks.size());
+    vector<unsigned long long> partial(chunks.size());
+
+    parallelFor(chunks.size(), [&](int c)
+                {
+        const vector<int> &array = arraylist[chunks[c].first];
+        size_t offset = chunks[c].second;
+        size_t length = min(VERIFY_CHUNK_SIZE, array.size() - offset);
+        chunk_sorted[c] = isSortedSpan(array.data() + offset, min(length + 1, array.size() - offset));
+        partial[c] = multisetHash(array.data() + offset, length); });
+
+    vector<char> sorted(total_cases, 1);
+    vector<unsigned long long> sorted_hashes(total_cases, 0);
+    for (size_t c = 0; c < chunks.size(); c++)
+    {
+        sorted[chunks[c].first] &= chunk_sorted[c];
+        sorted_hashes[chunks[c].first] += partial[c];
+    }
+
+    for (int i = 0; i < total_cases; i++)
+    {
+        if (!sorted[i] || sorted_hashes[i] != hashes[i])
+        {
+            incorrect_cases++;
+        }
+    }
+
+    if (incorrect_cases)
+    {
+        cout << sort_name << " Test Failed: ";
+        cout << (total_cases - incorrect_cases) << "/" << total_cases << endl;
+    }
+}
+
+void bubbleSort(vector<int> &array)
+{
+    // repeatedly swap adjacent elements if they are in the wrong order
+
+    for (int i = 0; i < array.size(); i++)
+    {
+        for (int j = 0; j < array.size() - i - 1; j++)
+        {
+            if (array[j] > array[j + 1])
+            {
+                swap(array[j], array[j + 1]);
+            }
+        }
+    }
+}
+
+void selectionSort(vector<int> &array)
+{
+    // select the minimum element from the unsorted part and place it at the beginning of the sorted part
+
+    for (int i = 0; i < array.size(); i++)
+    {
+        int min_index = i;
+        for (int j = i + 1; j < array.size(); j++)
+        {
+            if (array[j] < array[min_index])
+            {
+                min_index = j;
+            }
+        }
+        if (min_index != i)
+            swap(array[i], array[min_index]);
+    }
+}
+
+void insertionSort(vector<int> &array)
+{
+    // insert an element from the unsorted part into its correct position in the sorted part
+
+    for (int i = 1; i < array.size(); i++)
+    {
+        int key = array[i];
+        int j = i - 1;
         while (j >= 0 && array[j] > key)
         {
             array[j + 1] = array[j];
@@ -834,3 +1673,2184 @@ void gnomeSort(vector<int> &array)
         }
     }
 }
+
+int resolveK(int k, int n)
+{
+    // k = 0 selects the median, otherwise clamp k to the array size
+
+    if (k <= 0)
+    {
+        return (n + 1) / 2;
+    }
+    return k < n ? k : n;
+}
+
+void insertionSortRange(vector<int> &array, int left, int right)
+{
+    // insertion sort on the closed range [left, right]
+
+    for (int i = left + 1; i <= right; i++)
+    {
+        int key = array[i];
+        int j = i - 1;
+        while (j >= left && array[j] > key)
+        {
+            array[j + 1] = array[j];
+            j--;
+        }
+        array[j + 1] = key;
+    }
+}
+
+void partition3(vector<int> &array, int left, int right, int pivot, int &lt, int &gt)
+{
+    // three-way partition of [left, right] around the pivot value
+    // afterwards [left, lt) < pivot, [lt, gt] == pivot, (gt, right] > pivot
+    // keeps few unique inputs linear instead of degrading to O(n^2)
+
+    lt = left;
+    gt = right;
+    int i = left;
+    while (i <= gt)
+    {
+        if (array[i] < pivot)
+        {
+            swap(array[lt], array[i]);
+            lt++;
+            i++;
+        }
+        else if (array[i] > pivot)
+        {
+            swap(array[i], array[gt]);
+            gt--;
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+int medianOfMedians(vector<int> &array, int left, int right)
+{
+    // split [left, right] into groups of 5 and move each group median to the front
+    // the median of those medians is a pivot guaranteed to discard 30% of the range
+
+    if (right - left < 5)
+    {
+        insertionSortRange(array, left, right);
+        return left + (right - left) / 2;
+    }
+
+    int store = left;
+    for (int i = left; i <= right; i += 5)
+    {
+        int sub_right = min(i + 4, right);
+        insertionSortRange(array, i, sub_right);
+        swap(array[i + (sub_right - i) / 2], array[store]);
+        store++;
+    }
+
+    int mid = left + (store - left - 1) / 2;
+    introSelectRange(array, left, store - 1, mid, 0);
+    return mid;
+}
+
+void introSelectRange(vector<int> &array, int left, int right, int k, int depth)
+{
+    // quickselect with median-of-3 pivots on [left, right] until array[k] is in place
+    // once the depth budget is spent switch to median-of-medians pivots for O(n) worst case
+
+    while (right - left > 16)
+    {
+        int pivot;
+        if (depth > 0)
+        {
+            int mid = left + (right - left) / 2;
+            int a = array[left], b = array[mid], c = array[right];
+            pivot = max(min(a, b), min(max(a, b), c));
+            depth--;
+        }
+        else
+        {
+            pivot = array[medianOfMedians(array, left, right)];
+        }
+
+        int lt, gt;
+        partition3(array, left, right, pivot, lt, gt);
+
+        if (k < lt)
+        {
+            right = lt - 1;
+        }
+        else if (k > gt)
+        {
+            left = gt + 1;
+        }
+        else
+        {
+            return;
+        }
+    }
+    insertionSortRange(array, left, right);
+}
+
+void floydRivestRange(vector<int> &array, int left, int right, int k)
+{
+    // sample a small range around the expected position of k and recurse on it
+    // so the partition pivot lands very close to k and the range shrinks fast
+
+    while (right > left)
+    {
+        if (right - left > 600)
+        {
+            double n = right - left + 1;
+            double i = k - left + 1;
+            double z = log(n);
+            double s = 0.5 * exp(2 * z / 3);
+            double sd = 0.5 * sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1 : 1);
+            int new_left = max(left, (int)(k - i * s / n + sd));
+            int new_right = min(right, (int)(k + (n - i) * s / n + sd));
+            floydRivestRange(array, new_left, new_right, k);
+        }
+
+        int t = array[k];
+        int i = left;
+        int j = right;
+        swap(array[left], array[k]);
+        if (array[right] > t)
+        {
+            swap(array[right], array[left]);
+        }
+        while (i < j)
+        {
+            swap(array[i], array[j]);
+            i++;
+            j--;
+            while (array[i] < t)
+            {
+                i++;
+            }
+            while (array[j] > t)
+            {
+                j--;
+            }
+        }
+        if (array[left] == t)
+        {
+            swap(array[left], array[j]);
+        }
+        else
+        {
+            j++;
+            swap(array[j], array[right]);
+        }
+
+        if (j <= k)
+        {
+            left = j + 1;
+        }
+        if (k <= j)
+        {
+            right = j - 1;
+        }
+    }
+}
+
+void introSelect(vector<int> &array, int k)
+{
+    // nth element: place the k-th smallest element at index k - 1
+    // smaller elements end up on its left and larger elements on its right
+
+    int n = array.size();
+    if (n <= 1)
+    {
+        return;
+    }
+    k = resolveK(k, n);
+
+    int depth = 2 * (int)log2(n);
+    introSelectRange(array, 0, n - 1, k - 1, depth);
+}
+
+void floydRivestSelect(vector<int> &array, int k)
+{
+    // nth element with Floyd-Rivest sampling, fewer comparisons than quickselect on large arrays
+
+    int n = array.size();
+    if (n <= 1)
+    {
+        return;
+    }
+    k = resolveK(k, n);
+
+    floydRivestRange(array, 0, n - 1, k - 1);
+}
+
+void partialSort(vector<int> &array, int k)
+{
+    // select the k smallest elements and sort only them, O(n + k log k)
+
+    int n = array.size();
+    if (n <= 1)
+    {
+        return;
+    }
+    k = resolveK(k, n);
+
+    introSelect(array, k);
+    sort(array.begin(), array.begin() + k);
+}
+
+void topK(vector<int> &array, int k)
+{
+    // stream over the array keeping the k smallest elements in a bounded max heap at the front
+    // an element only enters the heap if it is smaller than the current maximum, O(n log k)
+    // finally heap sort the front so the k smallest are in increasing order
+
+    int n = array.size();
+    if (n <= 1)
+    {
+        return;
+    }
+    k = resolveK(k, n);
+
+    for (int i = k / 2 - 1; i >= 0; i--)
+    {
+        heapify(array, k, i);
+    }
+
+    for (int i = k; i < n; i++)
+    {
+        if (array[i] < array[0])
+        {
+            swap(array[0], array[i]);
+            heapify(array, k, 0);
+        }
+    }
+
+    for (int i = k - 1; i > 0; i--)
+    {
+        swap(array[0], array[i]);
+        heapify(array, i, 0);
+    }
+}
+
+void testSelection(const vector<vector<int>> &original, const vector<vector<int>> &result, int k, string select_name, bool sorted_prefix)
+{
+    int incorrect_cases = 0;
+    int total_cases = result.size();
+
+    // compare each selection against a fully sorted copy of the original test case
+    for (int i = 0; i < total_cases; i++)
+    {
+        int n = result[i].size();
+        if (n == 0)
+        {
+            continue;
+        }
+        int kk = resolveK(k, n);
+
+        vector<int> expected(original[i]);
+        sort(expected.begin(), expected.end());
+
+        int pivot = result[i][kk - 1];
+        bool correct = pivot == expected[kk - 1];
+        for (int j = 0; correct && j < n; j++)
+        {
+            if ((j < kk && result[i][j] > pivot) || (j >= kk && result[i][j] < pivot))
+            {
+                correct = false;
+            }
+        }
+        for (int j = 0; correct && sorted_prefix && j < kk; j++)
+        {
+            if (result[i][j] != expected[j])
+            {
+                correct = false;
+            }
+        }
+
+        if (!correct)
+        {
+            incorrect_cases++;
+        }
+    }
+
+    if (incorrect_cases)
+    {
+        cout << select_name << " Test Failed: ";
+        cout << (total_cases - incorrect_cases) << "/" << total_cases << endl;
+    }
+}
+
+int gallopUpperBound(const vector<int> &array, int left, int right, int key)
+{
+    // first index in [left, right) whose element is greater than key
+    // search leftwards from right with exponential steps, then binary search inside the last step
+    // finding a position d elements away costs O(log d) instead of O(log n)
+
+    int bound = right;
+    int step = 1;
+    while (bound > left && array[bound - 1] > key)
+    {
+        int next = max(left, bound - step);
+        if (array[next] > key)
+        {
+            bound = next;
+            step *= 2;
+        }
+        else
+        {
+            return upper_bound(array.begin() + next + 1, array.begin() + bound, key) - array.begin();
+        }
+    }
+    return bound;
+}
+
+void gallopMerge(vector<int> &array, int left, int mid, int right)
+{
+    // buffer the right run and merge from the back
+    // each buffered element gallops to its position and the block after it moves in one go
+    // a tiny run only pays a binary insertion per element plus one pass of moves
+
+    vector<int> buffer(array.begin() + mid, array.begin() + right);
+    int hi = mid;
+    int out = right;
+    for (int j = buffer.size() - 1; j >= 0; j--)
+    {
+        int pos = gallopUpperBound(array, left, hi, buffer[j]);
+        move_backward(array.begin() + pos, array.begin() + hi, array.begin() + out);
+        out -= hi - pos;
+        hi = pos;
+        array[--out] = buffer[j];
+    }
+}
+
+void inPlaceMerge(vector<int> &array, int left, int mid, int right)
+{
+    // merge [left, mid) and [mid, right) without a buffer
+    // split the longer run in half, find the matching cut in the other run and rotate
+    // the middle blocks, then merge both halves recursively, O(n log n) moves
+
+    if (left >= mid || mid >= right)
+    {
+        return;
+    }
+    if (right - left == 2)
+    {
+        if (array[mid] < array[left])
+        {
+            swap(array[left], array[mid]);
+        }
+        return;
+    }
+
+    int cut1, cut2;
+    if (mid - left > right - mid)
+    {
+        cut1 = left + (mid - left) / 2;
+        cut2 = lower_bound(array.begin() + mid, array.begin() + right, array[cut1]) - array.begin();
+    }
+    else
+    {
+        cut2 = mid + (right - mid) / 2;
+        cut1 = upper_bound(array.begin() + left, array.begin() + mid, array[cut2]) - array.begin();
+    }
+
+    rotate(array.begin() + cut1, array.begin() + mid, array.begin() + cut2);
+    int new_mid = cut1 + (cut2 - mid);
+    inPlaceMerge(array, left, cut1, new_mid);
+    inPlaceMerge(array, new_mid, cut2, right);
+}
+
+void mergeRuns(vector<int> &array, int left, int mid, int right, int scratch_limit)
+{
+    // merge the adjacent sorted runs [left, mid) and [mid, right)
+    // buffer the right run if it fits the scratch limit, otherwise merge in place
+
+    if (left >= mid || mid >= right || array[mid - 1] <= array[mid])
+    {
+        return;
+    }
+
+    if (right - mid <= max(scratch_limit, GALLOP_BATCH_SIZE))
+    {
+        gallopMerge(array, left, mid, right);
+    }
+    else
+    {
+        inPlaceMerge(array, left, mid, right);
+    }
+}
+
+void appendBatch(SortedRuns &runs, const vector<int> &batch)
+{
+    // sort only the new batch and push it as a pending run
+    // like a binary counter, merge the newest run into the previous one while they are of similar size
+    // so there are O(log n) pending runs and each element is merged O(log n) times
+
+    if (batch.empty())
+    {
+        return;
+    }
+
+    int start = runs.data.size();
+    runs.data.insert(runs.data.end(), batch.begin(), batch.end());
+    sort(runs.data.begin() + start, runs.data.end());
+    runs.run_starts.push_back(start);
+
+    while (runs.run_starts.size() >= 2)
+    {
+        int n = runs.run_starts.size();
+        int prev = runs.run_starts[n - 2];
+        int last = runs.run_starts[n - 1];
+        if (last - prev > 2 * ((int)runs.data.size() - last))
+        {
+            break;
+        }
+        mergeRuns(runs.data, prev, last, runs.data.size(), runs.scratch_limit);
+        runs.run_starts.pop_back();
+    }
+
+    // fold the pending runs into the base lazily, only once they are worth a pass over it
+    int pending = runs.data.size() - runs.run_starts[0];
+    if ((int)runs.run_starts.size() > MAX_PENDING_RUNS || (long long)pending * COMPACT_RATIO > runs.run_starts[0])
+    {
+        compactRuns(runs);
+    }
+}
+
+void compactRuns(SortedRuns &runs)
+{
+    // merge the pending runs from the newest (smallest) one back into the base
+    // afterwards runs.data is fully sorted
+
+    while (!runs.run_starts.empty())
+    {
+        int n = runs.run_starts.size();
+        int left = n >= 2 ? runs.run_starts[n - 2] : 0;
+        mergeRuns(runs.data, left, runs.run_starts[n - 1], runs.data.size(), runs.scratch_limit);
+        runs.run_starts.pop_back();
+    }
+}
+
+void incrementalBenchmark(vector<vector<int>> &arraylist)
+{
+    // sort 90% of each test case as the base and append the rest in batches of 0.1%, 1% and 10% of the base
+    // compare the amortized cost per append of merging batches (buffered and in place)
+    // against re-sorting the whole array after every append
+
+    double ratios[] = {0.001, 0.01, 0.1};
+    clock_t start;
+
+    cout << "Amortized time per append:" << endl;
+    for (double ratio : ratios)
+    {
+        double buffered = 0, in_place = 0, resort = 0;
+        int appends = 0;
+        int incorrect_cases = 0;
+
+        for (auto &array : arraylist)
+        {
+            int n = array.size();
+            int base_size = n * 9 / 10;
+            int batch_size = max(1, (int)(base_size * ratio));
+
+            vector<int> base(array.begin(), array.begin() + base_size);
+            sort(base.begin(), base.end());
+
+            // full re-sort after every append
+            vector<int> expected(base);
+            start = clock();
+            for (int i = base_size; i < n; i += batch_size)
+            {
+                expected.insert(expected.end(), array.begin() + i, array.begin() + min(n, i + batch_size));
+                sort(expected.begin(), expected.end());
+            }
+            resort += clock() - start;
+
+            // merge each batch with unlimited scratch memory, then with none
+            for (int scratch_limit : {INT_MAX, 0})
+            {
+                SortedRuns runs;
+                runs.data = base;
+                runs.scratch_limit = scratch_limit;
+
+                start = clock();
+                for (int i = base_size; i < n; i += batch_size)
+                {
+                    appendBatch(runs, vector<int>(array.begin() + i, array.begin() + min(n, i + batch_size)));
+                }
+                compactRuns(runs);
+                (scratch_limit ? buffered : in_place) += clock() - start;
+
+                if (runs.data != expected)
+                {
+                    incorrect_cases++;
+                }
+            }
+
+            appends += (n - base_size + batch_size - 1) / batch_size;
+        }
+
+        if (appends == 0)
+        {
+            continue;
+        }
+
+        double per_append = (double)1000 / CLOCKS_PER_SEC / appends;
+        cout << ratio * 100 << "% appends (" << appends << " appends):" << endl;
+        cout << "  buffered merge: " << buffered * per_append << " ms per append" << endl;
+        cout << "  in-place merge: " << in_place * per_append << " ms per append" << endl;
+        cout << "  full re-sort: " << resort * per_append << " ms per append" << endl;
+
+        if (incorrect_cases)
+        {
+            cout << "incremental Test Failed: ";
+            cout << (2 * arraylist.size() - incorrect_cases) << "/" << 2 * arraylist.size() << endl;
+        }
+    }
+}
+
+vector<int> generateArray(int distribution, int n, unsigned long long key)
+{
+    // one test case in memory, generated in blocks across all threads
+    vector<int> array(n);
+    int blocks = (n + GENERATOR_BLOCK_SIZE - 1) / GENERATOR_BLOCK_SIZE;
+    parallelFor(blocks, [&](int b)
+                {
+        long long begin = (long long)b * GENERATOR_BLOCK_SIZE;
+        long long end = min((long long)n, begin + GENERATOR_BLOCK_SIZE);
+        for (long long i = begin; i < end; i++)
+        {
+            array[i] = generateValue(distribution, i, n, key, 32);
+        } });
+    return array;
+}
+
+double timeSort(void (*sortFunction)(vector<int> &), const vector<int> &array, double budget)
+{
+    // wall time in ms per sort of a copy of array, repeated until SWEEP_MIN_MEASURE_MS is measured
+    // the sort runs in a forked child as a watchdog: if no result arrives within the budget
+    // the child is killed and -1 is returned, a crashing sort also returns -1
+
+    int fd[2];
+    if (pipe(fd) != 0)
+    {
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(fd[0]);
+        close(fd[1]);
+        return -1;
+    }
+    if (pid == 0)
+    {
+        close(fd[0]);
+        double total = 0;
+        int runs = 0;
+        while (total < SWEEP_MIN_MEASURE_MS)
+        {
+            vector<int> copy(array);
+            auto start = chrono::steady_clock::now();
+            sortFunction(copy);
+            total += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            runs++;
+        }
+        double duration = total / runs;
+        ssize_t written = write(fd[1], &duration, sizeof(duration));
+        _exit(written == sizeof(duration) ? 0 : 1);
+    }
+
+    close(fd[1]);
+    double duration = -1;
+    struct pollfd watch = {fd[0], POLLIN, 0};
+    // the child may repeat a fast sort, give it the measuring time on top of the budget
+    if (poll(&watch, 1, (int)(budget + SWEEP_MIN_MEASURE_MS) + 1) <= 0 ||
+        read(fd[0], &duration, sizeof(duration)) != sizeof(duration))
+    {
+        kill(pid, SIGKILL);
+        duration = -1;
+    }
+    close(fd[0]);
+    waitpid(pid, NULL, 0);
+    return duration;
+}
+
+double complexityModel(int model, double n)
+{
+    switch (model)
+    {
+    case LINEAR:
+        return n;
+    case LINEARITHMIC:
+        return n * log2(n);
+    case QUADRATIC:
+        return n * n;
+    }
+    return 0;
+}
+
+double fitComplexity(int model, const vector<double> &sizes, const vector<double> &times, double &coefficient)
+{
+    // least squares fit of times = coefficient * model(size) on relative errors,
+    // so small sizes weigh as much as large ones; returns the mean squared relative error
+
+    double numerator = 0, denominator = 0;
+    for (size_t i = 0; i < sizes.size(); i++)
+    {
+        double f = complexityModel(model, sizes[i]) / times[i];
+        numerator += f;
+        denominator += f * f;
+    }
+    coefficient = numerator / denominator;
+
+    double error = 0;
+    for (size_t i = 0; i < sizes.size(); i++)
+    {
+        double relative = coefficient * complexityModel(model, sizes[i]) / times[i] - 1;
+        error += relative * relative;
+    }
+    return error / sizes.size();
+}
+
+void sweep(const map<string, void (*)(vector<int> &)> &algorithms, const SweepOptions &options, const GeneratorOptions &generator)
+{
+    // for every distribution time each algorithm at min_size, 2 * min_size, ... max_size
+    // before each run project its time from the best fitting model so far (n^2 from a single point)
+    // and stop the algorithm once the projection or the actual run exceeds the budget
+
+    vector<int> sizes;
+    for (long long n = options.min_size; n <= options.max_size; n *= 2)
+    {
+        sizes.push_back(n);
+    }
+
+    cout << "Sweep: n = " << options.min_size << " .. " << sizes.back() << ", budget " << options.budget << " ms per run";
+    cout << " (seed " << generator.seed << ")" << endl;
+
+    for (int distribution : generator.distributions)
+    {
+        cout << endl
+             << "== " << DISTRIBUTION_NAMES[distribution] << " ==" << endl;
+
+        // times[algorithm][size index] in ms, -1 once skipped or aborted
+        map<string, vector<double>> times;
+        map<string, string> stopped;
+        for (auto &algorithm : algorithms)
+        {
+            times[algorithm.first] = vector<double>(sizes.size(), -1);
+        }
+
+        cout << setw(12) << "n";
+        for (auto &algorithm : algorithms)
+        {
+            cout << setw(12) << algorithm.first;
+        }
+        cout << endl;
+
+        for (size_t s = 0; s < sizes.size(); s++)
+        {
+            vector<int> array = generateArray(distribution, sizes[s], mix64(generator.seed ^ mix64(distribution + 1)));
+
+            cout << setw(12) << sizes[s];
+            for (auto &algorithm : algorithms)
+            {
+                vector<double> &measured = times[algorithm.first];
+                if (stopped.count(algorithm.first))
+                {
+                    cout << setw(12) << "-";
+                    continue;
+                }
+
+                // project this run from the previous measurements
+                vector<double> fit_sizes, fit_times;
+                for (size_t p = 0; p < s; p++)
+                {
+                    if (measured[p] > 0)
+                    {
+                        fit_sizes.push_back(sizes[p]);
+                        fit_times.push_back(measured[p]);
+                    }
+                }
+                double projected = 0;
+                if (fit_sizes.size() == 1)
+                {
+                    projected = fit_times[0] * complexityModel(QUADRATIC, sizes[s]) / complexityModel(QUADRATIC, fit_sizes[0]);
+                }
+                else if (fit_sizes.size() > 1)
+                {
+                    double best_error = -1;
+                    for (int model = 0; model < COMPLEXITY_COUNT; model++)
+                    {
+                        double coefficient;
+                        double error = fitComplexity(model, fit_sizes, fit_times, coefficient);
+                        if (best_error < 0 || error < best_error)
+                        {
+                            best_error = error;
+                            projected = coefficient * complexityModel(model, sizes[s]);
+                        }
+                    }
+                }
+                if (projected > options.budget)
+                {
+                    stopped[algorithm.first] = "skipped from n = " + to_string(sizes[s]) + ", projected " + to_string((int)projected) + " ms";
+                    cout << setw(12) << "skip";
+                    continue;
+                }
+
+                measured[s] = timeSort(algorithm.second, array, options.budget);
+                if (measured[s] < 0)
+                {
+                    stopped[algorithm.first] = "aborted at n = " + to_string(sizes[s]) + " (over budget or crashed)";
+                    cout << setw(12) << "abort";
+                    continue;
+                }
+                cout << setw(12) << setprecision(4) << measured[s];
+            }
+            cout << endl;
+        }
+
+        // fit every algorithm to the complexity models
+        cout << "Complexity (ms):" << endl;
+        for (auto &algorithm : algorithms)
+        {
+            vector<double> fit_sizes, fit_times;
+            for (size_t s = 0; s < sizes.size(); s++)
+            {
+                if (times[algorithm.first][s] > 0)
+                {
+                    fit_sizes.push_back(sizes[s]);
+                    fit_times.push_back(times[algorithm.first][s]);
+                }
+            }
+
+            cout << "  " << algorithm.first << ": ";
+            if (fit_sizes.size() < 2)
+            {
+                cout << "not enough measurements";
+            }
+            else
+            {
+                int best_model = 0;
+                double best_error = -1, best_coefficient = 0;
+                for (int model = 0; model < COMPLEXITY_COUNT; model++)
+                {
+                    double coefficient;
+                    double error = fitComplexity(model, fit_sizes, fit_times, coefficient);
+                    if (best_error < 0 || error < best_error)
+                    {
+                        best_model = model;
+                        best_error = error;
+                        best_coefficient = coefficient;
+                    }
+                }
+                cout << "O(" << COMPLEXITY_NAMES[best_model] << "), " << best_coefficient << " * " << COMPLEXITY_NAMES[best_model];
+                cout << " (rms error " << setprecision(2) << sqrt(best_error) * 100 << "%)" << setprecision(4);
+            }
+            if (stopped.count(algorithm.first))
+            {
+                cout << ", " << stopped[algorithm.first];
+            }
+            cout << endl;
+        }
+
+        // a crossover is where the faster of two algorithms changes between consecutive sizes,
+        // interpolated on the log-log curves
+        cout << "Crossovers:" << endl;
+        bool found = false;
+        for (auto a = algorithms.begin(); a != algorithms.end(); a++)
+        {
+            for (auto b = next(a); b != algorithms.end(); b++)
+            {
+                const vector<double> &ta = times[a->first];
+                const vector<double> &tb = times[b->first];
+                for (size_t s = 1; s < sizes.size(); s++)
+                {
+                    if (ta[s - 1] <= 0 || tb[s - 1] <= 0 || ta[s] <= 0 || tb[s] <= 0)
+                    {
+                        continue;
+                    }
+                    double d1 = log(ta[s - 1] / tb[s - 1]);
+                    double d2 = log(ta[s] / tb[s]);
+                    if ((d1 < 0) == (d2 < 0))
+                    {
+                        continue;
+                    }
+                    double n = exp(log(sizes[s - 1]) + (log(sizes[s]) - log(sizes[s - 1])) * d1 / (d1 - d2));
+                    cout << "  " << a->first << " / " << b->first << ": n ~ " << (long long)n;
+                    cout << " (" << (d2 < 0 ? a->first : b->first) << " faster above)" << endl;
+                    found = true;
+                }
+            }
+        }
+        if (!found)
+        {
+            cout << "  none" << endl;
+        }
+    }
+}
+
+bool readFull(int fd, void *buffer, size_t size, int *passed_fd)
+{
+    // read exactly size bytes, a file descriptor passed along (SCM_RIGHTS) is stored in passed_fd
+
+    char *p = (char *)buffer;
+    while (size > 0)
+    {
+        struct iovec io = {p, size};
+        char control[CMSG_SPACE(sizeof(int))];
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        ssize_t received = recvmsg(fd, &message, 0);
+        if (received <= 0)
+        {
+            return false;
+        }
+        struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+        if (header && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS)
+        {
+            int descriptor;
+            memcpy(&descriptor, CMSG_DATA(header), sizeof(int));
+            // keep only the first descriptor of a message, never overwrite one
+            if (passed_fd && *passed_fd < 0)
+            {
+                *passed_fd = descriptor;
+            }
+            else
+            {
+                close(descriptor);
+            }
+        }
+        p += received;
+        size -= received;
+    }
+    return true;
+}
+
+bool writeFull(int fd, const void *buffer, size_t size, int passed_fd)
+{
+    // write exactly size bytes, passed_fd (if not -1) is sent along with the first byte
+
+    const char *p = (const char *)buffer;
+    while (size > 0)
+    {
+        struct iovec io = {(void *)p, size};
+        char control[CMSG_SPACE(sizeof(int))];
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        if (passed_fd >= 0)
+        {
+            memset(control, 0, sizeof(control));
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(header), &passed_fd, sizeof(int));
+            passed_fd = -1;
+        }
+
+        ssize_t sent = sendmsg(fd, &message, 0);
+        if (sent <= 0)
+        {
+            return false;
+        }
+        p += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+int connectServer(const string &socket_path)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+    {
+        cerr << "Error: Cannot connect to " << socket_path << endl;
+        cerr << "Please run './sort serve' first" << endl;
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+void serverWorker(SortServer &server)
+{
+    // take a fair share of the queue per wake up so small requests share one lock round trip
+    // without one worker hoarding jobs the idle ones could run, large jobs are never batched
+    // the sort functions take a vector, so each array is copied out of and back into the segment
+
+    vector<int> array;
+    vector<SortJob> batch;
+    while (true)
+    {
+        {
+            unique_lock<mutex> guard(server.lock);
+            server.ready.wait(guard, [&]()
+                              { return !server.queue.empty(); });
+            size_t take = max((size_t)1, min((size_t)SERVER_BATCH_SIZE, server.queue.size() / server.workers));
+            unsigned long long elements = 0;
+            while (!server.queue.empty() && batch.size() < take &&
+                   (batch.empty() || elements + server.queue.front().request.count <= SERVER_BATCH_ELEMENTS))
+            {
+                elements += server.queue.front().request.count;
+                batch.push_back(move(server.queue.front()));
+                server.queue.pop_front();
+            }
+            server.batches++;
+        }
+
+        for (auto &job : batch)
+        {
+            ServerResponse response;
+            memset(&response, 0, sizeof(response));
+            response.id = job.request.id;
+
+            // the segment is only written back after a successful sort, a failure answers status 1
+            // the checks run on the private copy since the client may still change the segment
+            int *data = job.client->segment + job.request.offset;
+            if (job.request.count > 1)
+            {
+                array.assign(data, data + job.request.count);
+                try
+                {
+                    if (serverCanSort(job.sortFunction, array))
+                    {
+                        job.sortFunction(array);
+                        copy(array.begin(), array.end(), data);
+                    }
+                    else
+                    {
+                        response.status = 1;
+                    }
+                }
+                catch (const exception &)
+                {
+                    response.status = 1;
+                }
+            }
+            queueResponse(*job.client, response, true);
+
+            double latency = chrono::duration<double, micro>(chrono::steady_clock::now() - job.received).count();
+            lock_guard<mutex> guard(server.lock);
+            server.requests++;
+            server.elements += job.request.count;
+            server.total_latency_us += latency;
+            server.max_latency_us = max(server.max_latency_us, latency);
+        }
+        batch.clear();
+    }
+}
+
+bool serverCanSort(void (*sortFunction)(vector<int> &), const vector<int> &array)
+{
+    // counting, radix and bucket sort crash or overflow outside their preconditions,
+    // which would take the whole server down with them
+
+    if (sortFunction != countingSort && sortFunction != radixSort && sortFunction != bucketSort)
+    {
+        return true;
+    }
+
+    auto extremes = minmax_element(array.begin(), array.end());
+    long long min = *extremes.first, max = *extremes.second;
+    if (sortFunction == countingSort)
+    {
+        return max - min < SERVER_COUNTING_RANGE;
+    }
+    if (sortFunction == radixSort)
+    {
+        // negative digits index out of the counts, the place value overflows past 10^9
+        return min >= 0 && max < 1000000000;
+    }
+    // bucket indices are computed as (value - min) * n in int
+    return (max - min + 1) * (long long)array.size() <= INT_MAX;
+}
+
+void handleConnection(SortServer &server, shared_ptr<ClientConnection> client, const map<string, void (*)(vector<int> &)> &sortFunctions)
+{
+    // read requests until the client disconnects, sorts are queued and answered by the workers
+    // so a client can pipeline many requests; pending jobs keep the connection alive
+
+    ServerRequest request;
+    int passed_fd = -1;
+    while (readFull(client->fd, &request, sizeof(request), &passed_fd))
+    {
+        ServerResponse response;
+        memset(&response, 0, sizeof(response));
+        response.id = request.id;
+        request.algorithm[sizeof(request.algorithm) - 1] = '\0';
+
+        // only a segment request may pass a descriptor
+        if (request.type != REQUEST_SEGMENT && passed_fd >= 0)
+        {
+            close(passed_fd);
+            passed_fd = -1;
+        }
+
+        if (request.type == REQUEST_SORT)
+        {
+            auto sortFunction = sortFunctions.find(request.algorithm);
+            if (sortFunction != sortFunctions.end() && client->segment &&
+                request.offset <= client->segment_size / sizeof(int) &&
+                request.count <= client->segment_size / sizeof(int) - request.offset)
+            {
+                SortJob job = {client, request, sortFunction->second, chrono::steady_clock::now()};
+                {
+                    lock_guard<mutex> guard(client->write_lock);
+                    client->pending++;
+                }
+                lock_guard<mutex> guard(server.lock);
+                server.queue.push_back(job);
+                server.ready.notify_one();
+                continue;
+            }
+            response.status = 1;
+        }
+        else if (request.type == REQUEST_SEGMENT)
+        {
+            // a connection attaches one segment for its lifetime
+            // the segment must really be as large as claimed and, on Linux, sealed against
+            // shrinking, otherwise touching the missing pages kills the server with SIGBUS
+            void *segment = MAP_FAILED;
+            struct stat status;
+            bool valid = passed_fd >= 0 && !client->segment && request.offset > 0 &&
+                         fstat(passed_fd, &status) == 0 && request.offset <= (unsigned long long)status.st_size;
+#ifdef __linux__
+            valid = valid && (fcntl(passed_fd, F_GET_SEALS) & F_SEAL_SHRINK);
+#endif
+            if (valid)
+            {
+                segment = mmap(NULL, request.offset, PROT_READ | PROT_WRITE, MAP_SHARED, passed_fd, 0);
+            }
+            if (passed_fd >= 0)
+            {
+                close(passed_fd);
+                passed_fd = -1;
+            }
+            if (segment == MAP_FAILED)
+            {
+                response.status = 1;
+            }
+            else
+            {
+                client->segment = (int *)segment;
+                client->segment_size = request.offset;
+            }
+        }
+        else if (request.type == REQUEST_STATS)
+        {
+            lock_guard<mutex> guard(server.lock);
+            response.requests = server.requests;
+            response.elements = server.elements;
+            response.batches = server.batches;
+            response.uptime_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - server.started).count();
+            response.mean_latency_us = server.requests ? server.total_latency_us / server.requests : 0;
+            response.max_latency_us = server.max_latency_us;
+        }
+        else
+        {
+            response.status = 1;
+        }
+
+        queueResponse(*client, response, false);
+    }
+    if (passed_fd >= 0)
+    {
+        close(passed_fd);
+    }
+
+    lock_guard<mutex> guard(client->write_lock);
+    client->closed = true;
+    client->writable.notify_one();
+}
+
+void queueResponse(ClientConnection &client, const ServerResponse &response, bool job_done)
+{
+    // hand a response to the connection's writer, never blocks on the socket
+
+    lock_guard<mutex> guard(client.write_lock);
+    client.responses.push_back(response);
+    if (job_done)
+    {
+        client.pending--;
+    }
+    client.writable.notify_one();
+}
+
+void connectionWriter(shared_ptr<ClientConnection> client)
+{
+    // the only thread writing to the socket, so a client that stops reading stalls
+    // its own writer instead of every worker; exits once the reader is done and
+    // every queued job has been answered, releasing the connection
+
+    bool broken = false;
+    deque<ServerResponse> batch;
+    unique_lock<mutex> guard(client->write_lock);
+    while (true)
+    {
+        client->writable.wait(guard, [&]()
+                              { return !client->responses.empty() || (client->closed && client->pending == 0); });
+        if (client->responses.empty())
+        {
+            break;
+        }
+        batch.swap(client->responses);
+        guard.unlock();
+        for (auto &response : batch)
+        {
+            // after a failed write the remaining responses are dropped
+            broken = broken || !writeFull(client->fd, &response, sizeof(response));
+        }
+        batch.clear();
+        guard.lock();
+    }
+}
+
+int serve(const string &socket_path, const map<string, void (*)(vector<int> &)> &sortFunctions)
+{
+    // accept clients forever, one thread per connection and a shared pool of sort workers
+
+    signal(SIGPIPE, SIG_IGN);
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    unlink(socket_path.c_str());
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listen_fd, 64) != 0)
+    {
+        cerr << "Error: Cannot listen on " << socket_path << endl;
+        return 1;
+    }
+
+    SortServer server;
+    server.started = chrono::steady_clock::now();
+    server.requests = server.elements = server.batches = 0;
+    server.total_latency_us = server.max_latency_us = 0;
+
+    server.workers = max(1, (int)thread::hardware_concurrency());
+    for (int i = 0; i < server.workers; i++)
+    {
+        thread(serverWorker, ref(server)).detach();
+    }
+    cout << "Serving on " << socket_path << " with " << server.workers << " workers" << endl;
+
+    while (true)
+    {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0)
+        {
+            continue;
+        }
+        shared_ptr<ClientConnection> client(new ClientConnection());
+        client->fd = fd;
+        client->segment = NULL;
+        client->segment_size = 0;
+        client->pending = 0;
+        client->closed = false;
+        thread(connectionWriter, client).detach();
+        thread(handleConnection, ref(server), client, cref(sortFunctions)).detach();
+    }
+    return 0;
+}
+
+int sortClient(const string &socket_path, const string &algorithm)
+{
+    // copy the test cases into one memfd segment, attach it to the server,
+    // pipeline a sort request per test case and verify the result in the segment
+
+    vector<vector<int>> arraylist;
+    if (!readFile(arraylist))
+    {
+        return 1;
+    }
+    vector<unsigned long long> hashes = checksum(arraylist);
+
+    size_t total = 0;
+    for (auto &array : arraylist)
+    {
+        total += array.size();
+    }
+    size_t segment_size = max((size_t)1, total) * sizeof(int);
+
+#ifdef __linux__
+    // the server only accepts a segment that can no longer shrink
+    int segment_fd = memfd_create("sort", MFD_ALLOW_SEALING);
+#else
+    string name = "/sort." + to_string(getpid());
+    int segment_fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    shm_unlink(name.c_str());
+#endif
+    if (segment_fd < 0 || ftruncate(segment_fd, segment_size) != 0
+#ifdef __linux__
+        || fcntl(segment_fd, F_ADD_SEALS, F_SEAL_SHRINK) != 0
+#endif
+    )
+    {
+        cerr << "Error: Cannot create shared memory" << endl;
+        return 1;
+    }
+    int *segment = (int *)mmap(NULL, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, segment_fd, 0);
+    if (segment == MAP_FAILED)
+    {
+        cerr << "Error: Cannot map shared memory" << endl;
+        return 1;
+    }
+
+    vector<size_t> offsets;
+    size_t offset = 0;
+    for (auto &array : arraylist)
+    {
+        offsets.push_back(offset);
+        copy(array.begin(), array.end(), segment + offset);
+        offset += array.size();
+    }
+
+    int fd = connectServer(socket_path);
+    if (fd < 0)
+    {
+        return 1;
+    }
+
+    ServerRequest request;
+    ServerResponse response;
+    memset(&request, 0, sizeof(request));
+    request.type = REQUEST_SEGMENT;
+    request.offset = segment_size;
+    if (!writeFull(fd, &request, sizeof(request), segment_fd) || !readFull(fd, &response, sizeof(response)) || response.status)
+    {
+        cerr << "Error: Server rejected the shared memory segment" << endl;
+        return 1;
+    }
+    close(segment_fd);
+
+    cout << "Sorting with " << algorithm << " sort on " << socket_path << "..." << endl;
+    auto start = chrono::steady_clock::now();
+
+    request.type = REQUEST_SORT;
+    strncpy(request.algorithm, algorithm.c_str(), sizeof(request.algorithm) - 1);
+    for (size_t i = 0; i < arraylist.size(); i++)
+    {
+        request.id = i;
+        request.offset = offsets[i];
+        request.count = arraylist[i].size();
+        if (!writeFull(fd, &request, sizeof(request)))
+        {
+            cerr << "Error: Lost connection to the server" << endl;
+            return 1;
+        }
+    }
+
+    int failed = 0;
+    for (size_t i = 0; i < arraylist.size(); i++)
+    {
+        if (!readFull(fd, &response, sizeof(response)))
+        {
+            cerr << "Error: Lost connection to the server" << endl;
+            return 1;
+        }
+        failed += response.status != 0;
+    }
+
+    double duration = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << "Time: " << duration / max((size_t)1, arraylist.size()) << " ms per test case (round trip)" << endl;
+    close(fd);
+
+    if (failed)
+    {
+        cerr << "Error: Server rejected " << failed << " requests (unknown algorithm or input it cannot sort)" << endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < arraylist.size(); i++)
+    {
+        copy(segment + offsets[i], segment + offsets[i] + arraylist[i].size(), arraylist[i].begin());
+    }
+    munmap(segment, segment_size);
+
+    test(arraylist, hashes, algorithm);
+    return 0;
+}
+
+int printServerStats(const string &socket_path)
+{
+    int fd = connectServer(socket_path);
+    if (fd < 0)
+    {
+        return 1;
+    }
+
+    ServerRequest request;
+    ServerResponse response;
+    memset(&request, 0, sizeof(request));
+    request.type = REQUEST_STATS;
+    if (!writeFull(fd, &request, sizeof(request)) || !readFull(fd, &response, sizeof(response)))
+    {
+        cerr << "Error: Lost connection to the server" << endl;
+        return 1;
+    }
+    close(fd);
+
+    double seconds = response.uptime_ms / 1000;
+    cout << "Uptime: " << seconds << " s" << endl;
+    cout << "Requests: " << response.requests << " (" << response.requests / seconds << " per s)" << endl;
+    cout << "Elements: " << response.elements << " (" << response.elements / seconds << " per s)" << endl;
+    cout << "Batches: " << response.batches << endl;
+    cout << "Latency: " << response.mean_latency_us << " us mean, " << response.max_latency_us << " us max" << endl;
+    return 0;
+}
+
+void generateStrings(const string &filename, int count, unsigned long long seed)
+{
+    // URLs, log lines and ids that share 30 to 200 character prefixes,
+    // followed by 12 hex digits whose leading digits are also mostly shared
+
+    const char *prefixes[] = {
+        "https://www.example.com/static/assets/images/catalog/products/home-and-garden/outdoor-furniture/"
+        "thumbnails/high-resolution/?utm_source=newsletter&utm_medium=email&utm_campaign=autumn-sale&item=",
+        "https://www.example.com/api/v2/customers/accounts/transactions/history/?region=eu-west-1&currency=EUR&"
+        "include=merchant,category,location&page_size=100&sort=-created_at&cursor=",
+        "2026-10-19 12:00:00.000 INFO [sort-server-worker-pool-thread] org.example.sort.server.RequestHandler "
+        "- request completed status=200 bytes=4096 algorithm=merge id=",
+        "2026-10-19 12:00:00.000 WARN [sort-server-worker-pool-thread] org.example.sort.server.RequestHandler "
+        "- request completed status=503 bytes=0 algorithm=merge id=",
+        "user:00000000-0000-4000-8000-"};
+    const int prefix_count = sizeof(prefixes) / sizeof(prefixes[0]);
+    const char *hex = "0123456789abcdef";
+
+    FILE *file = fopen(filename.c_str(), "wb");
+    if (!file)
+    {
+        cerr << "Error opening file" << endl;
+        return;
+    }
+
+    string buffer;
+    for (int i = 0; i < count; i++)
+    {
+        unsigned long long r = counterRandom(seed, i);
+        buffer += prefixes[r % prefix_count];
+        unsigned long long id = (r >> 8) & 0xffffffffffULL; // 40 random bits
+        buffer += "00";
+        for (int d = 9; d >= 0; d--)
+        {
+            buffer += hex[(id >> (4 * d)) & 15];
+        }
+        buffer += '\n';
+
+        if (buffer.size() >= (1 << 20))
+        {
+            fwrite(buffer.data(), 1, buffer.size(), file);
+            buffer.clear();
+        }
+    }
+    fwrite(buffer.data(), 1, buffer.size(), file);
+    fclose(file);
+}
+
+bool readStringFile(const string &filename, StringArena &arena)
+{
+    // read the whole file into the arena in one go and cut it into lines without copying
+
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (!file)
+    {
+        cerr << "Error opening file" << endl;
+        cerr << "Please run './sort genstrings' to generate strings" << endl;
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    arena.chars.resize(length);
+    length = fread(arena.chars.data(), 1, length, file);
+    fclose(file);
+    arena.chars.resize(length);
+
+    const char *begin = arena.chars.data();
+    const char *p = begin;
+    const char *end = begin + length;
+    while (p < end)
+    {
+        const char *newline = (const char *)memchr(p, '\n', end - p);
+        const char *line_end = newline ? newline : end;
+        StringHandle handle = {(unsigned long long)(p - begin), (unsigned int)(line_end - p)};
+        if (handle.length && p[handle.length - 1] == '\r')
+        {
+            handle.length--;
+        }
+        arena.strings.push_back(handle);
+        p = line_end + 1;
+    }
+    return true;
+}
+
+int charAt(const char *chars, const StringHandle &s, size_t depth)
+{
+    // character at depth as 0 .. 255, or -1 past the end of the string
+    return depth < s.length ? (unsigned char)chars[s.offset + depth] : -1;
+}
+
+unsigned long long chunkAt(const char *chars, const StringHandle &s, size_t depth)
+{
+    // the STRING_CHUNK_SIZE characters at depth in the high bytes and the number of
+    // characters left (at most 8) in the low byte, so comparing chunks compares the strings
+    // and a shorter string sorts first; a low byte below 8 means the string ends in this chunk
+
+    size_t remaining = depth < s.length ? s.length - depth : 0;
+    const unsigned char *p = (const unsigned char *)chars + s.offset + depth;
+    unsigned long long chunk = 0;
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (remaining >= 8)
+    {
+        memcpy(&chunk, p, 8);
+        return (__builtin_bswap64(chunk) & ~0xffULL) | 8;
+    }
+#endif
+    for (size_t i = 0; i < STRING_CHUNK_SIZE && i < remaining; i++)
+    {
+        chunk |= (unsigned long long)p[i] << (56 - 8 * i);
+    }
+    return chunk | min(remaining, (size_t)8);
+}
+
+size_t commonPrefix(const char *chars, const StringHandle &a, const StringHandle &b, size_t from)
+{
+    // length of the common prefix of a and b, the first from characters are known to match
+    // compare 8 characters at a time, the lowest differing byte of the xor is the first mismatch
+
+    size_t n = min(a.length, b.length);
+    const char *pa = chars + a.offset;
+    const char *pb = chars + b.offset;
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (from + 8 <= n)
+    {
+        unsigned long long x, y;
+        memcpy(&x, pa + from, 8);
+        memcpy(&y, pb + from, 8);
+        if (x != y)
+        {
+            return from + __builtin_ctzll(x ^ y) / 8;
+        }
+        from += 8;
+    }
+#endif
+    while (from < n && pa[from] == pb[from])
+    {
+        from++;
+    }
+    return from;
+}
+
+bool lessFrom(const char *chars, const StringHandle &a, const StringHandle &b, size_t depth)
+{
+    // a < b given that the first depth characters match
+    size_t n = min(a.length, b.length);
+    if (depth < n)
+    {
+        int c = memcmp(chars + a.offset + depth, chars + b.offset + depth, n - depth);
+        if (c)
+        {
+            return c < 0;
+        }
+    }
+    return a.length < b.length;
+}
+
+void stringInsertionSort(const char *chars, StringHandle *a, size_t n, size_t depth)
+{
+    // insertion sort of strings that share their first depth characters
+    for (size_t i = 1; i < n; i++)
+    {
+        StringHandle key = a[i];
+        size_t j = i;
+        while (j > 0 && lessFrom(chars, key, a[j - 1], depth))
+        {
+            a[j] = a[j - 1];
+            j--;
+        }
+        a[j] = key;
+    }
+}
+
+void stdStringSort(StringArena &arena)
+{
+    // reference: std::sort with a memcmp comparison from the first character
+
+    const char *chars = arena.chars.data();
+    sort(arena.strings.begin(), arena.strings.end(), [chars](const StringHandle &a, const StringHandle &b)
+         { return lessFrom(chars, a, b, 0); });
+}
+
+void multikeyQuickSortRange(const char *chars, StringHandle *a, size_t n, size_t depth)
+{
+    // three-way partition on the chunk of characters at depth (Bentley-Sedgewick)
+    // the equal part moves on to the next chunk, so a shared prefix is read once per level
+    // instead of once per comparison, STRING_CHUNK_SIZE characters at a time
+
+    while (n > (size_t)STRING_INSERTION_SIZE)
+    {
+        // skip the prefix shared by the whole range, stops at the first string that differs
+        size_t shared = a[0].length;
+        for (size_t i = 1; i < n && shared > depth; i++)
+        {
+            shared = min(shared, commonPrefix(chars, a[0], a[i], depth));
+        }
+        depth = max(depth, shared);
+
+        unsigned long long x = chunkAt(chars, a[0], depth);
+        unsigned long long y = chunkAt(chars, a[n / 2], depth);
+        unsigned long long z = chunkAt(chars, a[n - 1], depth);
+        unsigned long long pivot = max(min(x, y), min(max(x, y), z));
+
+        size_t lt = 0, i = 0, gt = n;
+        while (i < gt)
+        {
+            unsigned long long c = chunkAt(chars, a[i], depth);
+            if (c < pivot)
+            {
+                std::swap(a[lt++], a[i++]);
+            }
+            else if (c > pivot)
+            {
+                std::swap(a[i], a[--gt]);
+            }
+            else
+            {
+                i++;
+            }
+        }
+
+        multikeyQuickSortRange(chars, a, lt, depth);
+        multikeyQuickSortRange(chars, a + gt, n - gt, depth);
+        if ((pivot & 0xff) < 8)
+        {
+            // the equal part holds strings that ended in this chunk, they are all equal
+            return;
+        }
+        a += lt;
+        n = gt - lt;
+        depth += STRING_CHUNK_SIZE;
+    }
+    stringInsertionSort(chars, a, n, depth);
+}
+
+void multikeyQuickSort(StringArena &arena)
+{
+    multikeyQuickSortRange(arena.chars.data(), arena.strings.data(), arena.strings.size(), 0);
+}
+
+void msdRadixSortRange(const char *chars, StringHandle *a, StringHandle *tmp, int *cache, size_t n, size_t depth)
+{
+    // most significant digit first radix sort with 257 buckets (end of string + 256 characters)
+    // the character at depth is read once per string into the cache, then counting and
+    // distributing only touch the cache instead of the scattered string data
+
+    // recurse into every bucket but the largest and loop on that one,
+    // so the recursion depth stays O(log n) even for nested prefixes (a, aa, aaa, ...)
+
+    while (n >= (size_t)STRING_RADIX_SIZE)
+    {
+        // skip the prefix shared by the whole range in one pass instead of one pass per character
+        size_t shared = a[0].length;
+        for (size_t i = 1; i < n && shared > depth; i++)
+        {
+            shared = min(shared, commonPrefix(chars, a[0], a[i], depth));
+        }
+        depth = max(depth, shared);
+
+        size_t count[258] = {0};
+        for (size_t i = 0; i < n; i++)
+        {
+            cache[i] = charAt(chars, a[i], depth) + 1;
+            count[cache[i] + 1]++;
+        }
+        for (int b = 1; b < 258; b++)
+        {
+            count[b] += count[b - 1];
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            tmp[count[cache[i]]++] = a[i];
+        }
+        copy(tmp, tmp + n, a);
+
+        // count[b] is now the end of bucket b, bucket 0 (ended strings) is done
+        int largest = 1;
+        for (int b = 2; b < 257; b++)
+        {
+            if (count[b] - count[b - 1] > count[largest] - count[largest - 1])
+            {
+                largest = b;
+            }
+        }
+        for (int b = 1; b < 257; b++)
+        {
+            size_t begin = count[b - 1];
+            if (b != largest && count[b] - begin > 1)
+            {
+                msdRadixSortRange(chars, a + begin, tmp, cache, count[b] - begin, depth + 1);
+            }
+        }
+
+        a += count[largest - 1];
+        n = count[largest] - count[largest - 1];
+        depth++;
+    }
+    multikeyQuickSortRange(chars, a, n, depth);
+}
+
+void msdRadixSort(StringArena &arena)
+{
+    size_t n = arena.strings.size();
+    vector<StringHandle> tmp(n);
+    vector<int> cache(n);
+    msdRadixSortRange(arena.chars.data(), arena.strings.data(), tmp.data(), cache.data(), n, 0);
+}
+
+void lcpMergeSortRange(const char *chars, StringHandle *a, size_t *lcp, StringHandle *tmp, size_t *tmp_lcp, size_t n)
+{
+    // merge sort that also returns lcp[i] = common prefix of a[i - 1] and a[i]
+    // while merging, h_a and h_b hold the common prefix of each head with the last output string;
+    // if they differ the head with the longer one is smaller without looking at any character,
+    // otherwise characters are only compared from that common prefix on
+
+    if (n <= (size_t)STRING_INSERTION_SIZE)
+    {
+        stringInsertionSort(chars, a, n, 0);
+        for (size_t i = 0; i < n; i++)
+        {
+            lcp[i] = i ? commonPrefix(chars, a[i - 1], a[i], 0) : 0;
+        }
+        return;
+    }
+
+    size_t mid = n / 2;
+    lcpMergeSortRange(chars, a, lcp, tmp, tmp_lcp, mid);
+    lcpMergeSortRange(chars, a + mid, lcp + mid, tmp, tmp_lcp, n - mid);
+
+    size_t i = 0, j = mid, k = 0;
+    size_t h_a = 0, h_b = 0;
+    while (i < mid && j < n)
+    {
+        if (h_a > h_b)
+        {
+            tmp[k] = a[i];
+            tmp_lcp[k++] = h_a;
+            if (++i < mid)
+            {
+                h_a = lcp[i];
+            }
+        }
+        else if (h_a < h_b)
+        {
+            tmp[k] = a[j];
+            tmp_lcp[k++] = h_b;
+            if (++j < n)
+            {
+                h_b = lcp[j];
+            }
+        }
+        else
+        {
+            size_t h = commonPrefix(chars, a[i], a[j], h_a);
+            if (!lessFrom(chars, a[j], a[i], h))
+            {
+                tmp[k] = a[i];
+                tmp_lcp[k++] = h_a;
+                h_b = h;
+                if (++i < mid)
+                {
+                    h_a = lcp[i];
+                }
+            }
+            else
+            {
+                tmp[k] = a[j];
+                tmp_lcp[k++] = h_b;
+                h_a = h;
+                if (++j < n)
+                {
+                    h_b = lcp[j];
+                }
+            }
+        }
+    }
+
+    // the head of the remaining run keeps its prefix with the last output, the rest keep their lcp
+    for (bool first = true; i < mid; i++, first = false)
+    {
+        tmp[k] = a[i];
+        tmp_lcp[k++] = first ? h_a : lcp[i];
+    }
+    for (bool first = true; j < n; j++, first = false)
+    {
+        tmp[k] = a[j];
+        tmp_lcp[k++] = first ? h_b : lcp[j];
+    }
+
+    copy(tmp, tmp + n, a);
+    copy(tmp_lcp, tmp_lcp + n, lcp);
+    lcp[0] = 0;
+}
+
+void lcpMergeSort(StringArena &arena)
+{
+    size_t n = arena.strings.size();
+    vector<size_t> lcp(n), tmp_lcp(n);
+    vector<StringHandle> tmp(n);
+    lcpMergeSortRange(arena.chars.data(), arena.strings.data(), lcp.data(), tmp.data(), tmp_lcp.data(), n);
+}
+
+void stringBenchmark(StringArena &arena)
+{
+    // sort the same lines with every string algorithm, verify against std::sort
+    // and report the speedup over it
+
+    map<string, void (*)(StringArena &)> stringSortFunctions = {
+        {"std", stdStringSort},
+        {"multikey", multikeyQuickSort},
+        {"msd_radix", msdRadixSort},
+        {"lcp_merge", lcpMergeSort}};
+
+    const char *chars = arena.chars.data();
+    size_t total_length = 0;
+    for (auto &s : arena.strings)
+    {
+        total_length += s.length;
+    }
+    cout << "Sorting " << arena.strings.size() << " strings (" << total_length / max((size_t)1, arena.strings.size()) << " characters on average)..." << endl;
+
+    StringArena expected = arena;
+    stdStringSort(expected);
+
+    vector<pair<string, double>> durations;
+    double reference = 0;
+    for (auto &stringSortFunction : stringSortFunctions)
+    {
+        StringArena copy = arena;
+        clock_t start = clock();
+        stringSortFunction.second(copy);
+        double duration = (double)(clock() - start) / CLOCKS_PER_SEC * 1000;
+        durations.push_back(make_pair(stringSortFunction.first, duration));
+        if (stringSortFunction.first == "std")
+        {
+            reference = duration;
+        }
+
+        // compare the contents, equal strings may come from different lines
+        size_t incorrect = 0;
+        for (size_t i = 0; i < copy.strings.size(); i++)
+        {
+            const StringHandle &a = copy.strings[i];
+            const StringHandle &b = expected.strings[i];
+            if (a.length != b.length || memcmp(chars + a.offset, chars + b.offset, a.length) != 0)
+            {
+                incorrect++;
+            }
+        }
+        if (incorrect)
+        {
+            cout << stringSortFunction.first << " Test Failed: " << incorrect << " strings out of place" << endl;
+        }
+    }
+
+    sort(durations.begin(), durations.end(), [](const pair<string, double> &a, const pair<string, double> &b)
+         { return a.second < b.second; });
+
+    cout << "Performance:" << endl;
+    for (auto &duration : durations)
+    {
+        cout << duration.first << ": " << duration.second << " ms";
+        cout << " (" << reference / max(duration.second, 1e-3) << "x std::sort)" << endl;
+    }
+}
+
+void stdSort(vector<int> &array)
+{
+    sort(array.begin(), array.end());
+}
+
+void stdStableSort(vector<int> &array)
+{
+    stable_sort(array.begin(), array.end());
+}
+
+#ifdef HAVE_PARALLEL_STL
+void parallelStdSort(vector<int> &array)
+{
+    sort(execution::par, array.begin(), array.end());
+}
+#endif
+
+BenchResult runBenchmark(const map<string, void (*)(vector<int> &)> &algorithms, const vector<int> &distributions, int size, unsigned long long seed, int runs, double budget)
+{
+    // each sample is one timeSort call, so a crashing or runaway algorithm only loses its samples
+    // runs are interleaved, every algorithm's r-th sample is taken in the same round as std_sort's,
+    // so the per-run ratio to std_sort cancels drift of the host
+
+    BenchResult result;
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+    time_t now = time(NULL);
+    char date[64];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    result.host = host;
+#ifdef __VERSION__
+    result.compiler = string(__VERSION__) + " c++" + to_string(__cplusplus);
+#else
+    result.compiler = "unknown c++" + to_string(__cplusplus);
+#endif
+    result.date = date;
+    result.size = size;
+    result.seed = seed;
+    for (auto &algorithm : algorithms)
+    {
+        result.algorithms.push_back(algorithm.first);
+    }
+
+    for (int distribution : distributions)
+    {
+        string name = DISTRIBUTION_NAMES[distribution];
+        result.distributions.push_back(name);
+        vector<int> array = generateArray(distribution, size, mix64(seed ^ mix64(distribution + 1)));
+
+        map<string, bool> failed;
+        for (int r = 0; r < runs; r++)
+        {
+            for (auto &algorithm : algorithms)
+            {
+                vector<double> &samples = result.samples[make_pair(name, algorithm.first)];
+                if (failed[algorithm.first])
+                {
+                    continue;
+                }
+                double duration = timeSort(algorithm.second, array, budget);
+                if (duration < 0)
+                {
+                    cerr << "Warning: " << algorithm.first << " on " << name << " crashed or exceeded the budget" << endl;
+                    failed[algorithm.first] = true;
+                    samples.clear();
+                    continue;
+                }
+                samples.push_back(duration);
+            }
+        }
+    }
+    return result;
+}
+
+bool saveBaseline(const string &filename, const BenchResult &result)
+{
+    // one "key value" line per field (distributions in generation order),
+    // then one "sample <distribution> <algorithm> <ms> ..." line per pair
+
+    ofstream file(filename.c_str(), ios::out | ios::trunc);
+    if (!file)
+    {
+        cerr << "Error opening " << filename << endl;
+        return false;
+    }
+
+    file << "host " << result.host << endl;
+    file << "compiler " << result.compiler << endl;
+    file << "date " << result.date << endl;
+    file << "size " << result.size << endl;
+    file << "seed " << result.seed << endl;
+    file << "distributions";
+    for (auto &distribution : result.distributions)
+    {
+        file << " " << distribution;
+    }
+    file << endl;
+    file << setprecision(9);
+    for (auto &samples : result.samples)
+    {
+        file << "sample " << samples.first.first << " " << samples.first.second;
+        for (double sample : samples.second)
+        {
+            file << " " << sample;
+        }
+        file << endl;
+    }
+    return true;
+}
+
+bool loadBaseline(const string &filename, BenchResult &result)
+{
+    ifstream file(filename.c_str());
+    if (!file)
+    {
+        cerr << "Error opening " << filename << endl;
+        cerr << "Please run './sort bench --save' to create a baseline" << endl;
+        return false;
+    }
+
+    string line;
+    while (getline(file, line))
+    {
+        stringstream stream(line);
+        string key;
+        stream >> key >> ws;
+        if (key == "host")
+        {
+            getline(stream, result.host);
+        }
+        else if (key == "compiler")
+        {
+            getline(stream, result.compiler);
+        }
+        else if (key == "date")
+        {
+            getline(stream, result.date);
+        }
+        else if (key == "size")
+        {
+            stream >> result.size;
+        }
+        else if (key == "seed")
+        {
+            stream >> result.seed;
+        }
+        else if (key == "distributions")
+        {
+            string distribution;
+            while (stream >> distribution)
+            {
+                result.distributions.push_back(distribution);
+            }
+        }
+        else if (key == "sample")
+        {
+            string distribution, algorithm;
+            stream >> distribution >> algorithm;
+            vector<double> &samples = result.samples[make_pair(distribution, algorithm)];
+            double sample;
+            while (stream >> sample)
+            {
+                samples.push_back(sample);
+            }
+            if (find(result.distributions.begin(), result.distributions.end(), distribution) == result.distributions.end())
+            {
+                result.distributions.push_back(distribution);
+            }
+            if (find(result.algorithms.begin(), result.algorithms.end(), algorithm) == result.algorithms.end())
+            {
+                result.algorithms.push_back(algorithm);
+            }
+        }
+    }
+    return true;
+}
+
+double median(vector<double> samples)
+{
+    if (samples.empty())
+    {
+        return 0;
+    }
+    size_t mid = samples.size() / 2;
+    nth_element(samples.begin(), samples.begin() + mid, samples.end());
+    return samples[mid];
+}
+
+vector<double> relativeSamples(const BenchResult &result, const string &distribution, const string &algorithm)
+{
+    // time of each run divided by std_sort's time in the same round
+
+    vector<double> ratios;
+    auto samples = result.samples.find(make_pair(distribution, algorithm));
+    auto reference = result.samples.find(make_pair(distribution, string("std_sort")));
+    if (samples == result.samples.end() || reference == result.samples.end())
+    {
+        return ratios;
+    }
+    for (size_t i = 0; i < samples->second.size() && i < reference->second.size(); i++)
+    {
+        ratios.push_back(samples->second[i] / reference->second[i]);
+    }
+    return ratios;
+}
+
+double mannWhitneyP(const vector<double> &baseline, const vector<double> &current)
+{
+    // one-sided Mann-Whitney U test that current tends to be slower than baseline
+    // rank based, so a few outlier runs do not decide the result; normal approximation of U
+
+    double n1 = baseline.size(), n2 = current.size();
+    double u = 0;
+    for (double c : current)
+    {
+        for (double b : baseline)
+        {
+            u += c > b ? 1 : c == b ? 0.5 : 0;
+        }
+    }
+    double mean = n1 * n2 / 2;
+    double deviation = sqrt(n1 * n2 * (n1 + n2 + 1) / 12);
+    double z = (u - mean - 0.5) / deviation;
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+int bench(const map<string, void (*)(vector<int> &)> &sortFunctions, const BenchOptions &options, const SweepOptions &sweep_options, const GeneratorOptions &generator)
+{
+    // benchmark the algorithms with std::sort and std::stable_sort as reference columns
+    // with --compare the baseline decides size, seed, distributions and algorithms, and every
+    // (distribution, algorithm) whose ratio to std::sort in the same run is significantly higher
+    // by more than the threshold fails the run; the references only measure the host, so a change
+    // in them is reported but never fails the run
+
+    map<string, void (*)(vector<int> &)> references = {
+        {"std_sort", stdSort},
+        {"std_stable", stdStableSort}};
+#ifdef HAVE_PARALLEL_STL
+    references["std_par"] = parallelStdSort;
+#endif
+
+    map<string, void (*)(vector<int> &)> algorithms(sortFunctions);
+    algorithms.insert(references.begin(), references.end());
+    vector<int> distributions = generator.distributions;
+    int size = generator.case_size;
+    unsigned long long seed = generator.seed;
+
+    BenchResult baseline;
+    if (options.compare)
+    {
+        if (!loadBaseline(options.baseline, baseline))
+        {
+            return 1;
+        }
+        size = baseline.size;
+        seed = baseline.seed;
+        distributions.clear();
+        for (auto &name : baseline.distributions)
+        {
+            int d = find(DISTRIBUTION_NAMES, DISTRIBUTION_NAMES + DISTRIBUTION_COUNT, name) - DISTRIBUTION_NAMES;
+            if (d < DISTRIBUTION_COUNT)
+            {
+                distributions.push_back(d);
+            }
+        }
+        // keep the baseline algorithms, plus the references in case the baseline lacks them
+        algorithms = references;
+        for (auto &name : baseline.algorithms)
+        {
+            if (sortFunctions.count(name))
+            {
+                algorithms[name] = sortFunctions.at(name);
+            }
+        }
+    }
+
+    cout << "Benchmark: n = " << size << ", " << options.runs << " runs, seed " << seed << endl;
+    BenchResult result = runBenchmark(algorithms, distributions, size, seed, options.runs, sweep_options.budget);
+
+    // median ms per run and the ratio to std::sort
+    for (auto &distribution : result.distributions)
+    {
+        cout << endl
+             << "== " << distribution << " ==" << endl;
+        double reference = median(result.samples[make_pair(distribution, "std_sort")]);
+        for (auto &algorithm : result.algorithms)
+        {
+            const vector<double> &samples = result.samples[make_pair(distribution, algorithm)];
+            cout << setw(12) << algorithm << ": ";
+            if (samples.empty())
+            {
+                cout << "-" << endl;
+                continue;
+            }
+            double ms = median(samples);
+            cout << setw(10) << setprecision(4) << ms << " ms";
+            cout << setw(10) << setprecision(3) << ms / reference << "x std::sort" << endl;
+        }
+    }
+
+    int regressions = 0;
+    if (options.compare)
+    {
+        cout << endl
+             << "Compared with " << options.baseline << " (" << baseline.date << ")" << endl;
+        if (baseline.host != result.host || baseline.compiler != result.compiler)
+        {
+            cout << "Warning: baseline from " << baseline.host << " (" << baseline.compiler << "), ";
+            cout << "now on " << result.host << " (" << result.compiler << ")" << endl;
+        }
+
+        // many pairs are tested at once, so each one has to pass a proportionally
+        // stricter level (Bonferroni) or noise alone fails a few pairs in every run
+        int compared = 0;
+        for (auto &previous : baseline.samples)
+        {
+            compared += !references.count(previous.first.second) && !relativeSamples(baseline, previous.first.first, previous.first.second).empty();
+        }
+        double significance = BENCH_SIGNIFICANCE / max(1, compared);
+
+        // walk the baseline, so a pair that crashed, ran past the budget or was dropped from the build
+        // (no samples now) is a regression as well
+        for (auto &previous : baseline.samples)
+        {
+            const string &distribution = previous.first.first, &algorithm = previous.first.second;
+            bool reference = references.count(algorithm) > 0;
+            vector<double> before = reference ? previous.second : relativeSamples(baseline, distribution, algorithm);
+            if (before.empty())
+            {
+                continue;
+            }
+            vector<double> after = reference ? result.samples[previous.first] : relativeSamples(result, distribution, algorithm);
+            if (after.empty())
+            {
+                cout << (reference ? "reference " : "REGRESSION ") << algorithm << " on " << distribution << ": ";
+                cout << "no samples (crashed, over budget or missing)" << endl;
+                regressions += !reference;
+                continue;
+            }
+            double change = (median(after) / median(before) - 1) * 100;
+            double p = mannWhitneyP(before, after);
+            bool slower = change > options.threshold && p < significance;
+            bool faster = change < -options.threshold && 1 - p < significance;
+            if (slower || faster)
+            {
+                cout << (reference ? "reference " : slower ? "REGRESSION " : "improvement ") << algorithm << " on " << distribution << ": ";
+                cout << setprecision(4) << median(before) << " -> " << median(after) << (reference ? " ms (" : "x std::sort (");
+                cout << (change > 0 ? "+" : "") << setprecision(3) << change << "%, p = " << p << ")";
+                cout << (reference ? ", the host changed, not counted" : "") << endl;
+            }
+            regressions += slower && !reference;
+        }
+        cout << regressions << " regressions over " << options.threshold << "% (p < " << significance << ")" << endl;
+    }
+
+    if (options.save && saveBaseline(options.baseline, result))
+    {
+        cout << "Baseline saved: " << options.baseline << endl;
+    }
+    return regressions ? 1 : 0;
+}